@@ -1,5 +1,6 @@
 #include "data_load.h"
 #include "utils.h"
+#include "hashmap.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -9,60 +10,138 @@
 #include <windows.h>
 #endif
 
+static char topic_names[MAX_TOPICS][32];
+static int topic_count = 0;
+
+/* Topic tag -> bit index (registered on first use); -1 if the table is full */
+int topic_id(const char *name) {
+    for (int i = 0; i < topic_count; i++) {
+        if (strcmp(topic_names[i], name) == 0) return i;
+    }
+    if (topic_count == MAX_TOPICS) return -1;
+    strncpy(topic_names[topic_count], name, sizeof(topic_names[0]) - 1);
+    return topic_count++;
+}
+
+/* Bit index -> topic tag ("" if unknown) */
+const char *topic_name(int id) {
+    if (id < 0 || id >= topic_count) return "";
+    return topic_names[id];
+}
+
+/* Parse "Tags: a, b, c" into a topic bit set */
+static uint64_t parse_tags(const char *list) {
+    uint64_t mask = 0;
+    char name[32];
+    while (*list) {
+        while (*list == ' ' || *list == ',') list++;
+        int len = 0;
+        while (*list && *list != ',') {
+            if (len < (int)sizeof(name) - 1) name[len++] = *list;
+            list++;
+        }
+        while (len > 0 && name[len-1] == ' ') len--;
+        name[len] = '\0';
+        if (len > 0) {
+            int id = topic_id(name);
+            if (id >= 0) mask |= 1ULL << id;
+        }
+    }
+    return mask;
+}
+
+/* fgets that also advances *pos by the bytes it read, so explanation
+   offsets are exact byte positions (no ftell) */
+static char *read_counted(char *buf, int sz, FILE *fp, long *pos) {
+    if (!fgets(buf, sz, fp)) return NULL;
+    *pos += (long)strlen(buf);
+    return buf;
+}
+
 /* Parse quiz file into Question array; return count loaded */
-/* Format: question, 4 options, answer (1-4) */
+/* Format: question, 4 options, answer (1-4), optional Tags:/Difficulty:/Explanation: lines */
+/* path must outlive the questions (explanations are read from it later) */
 int load_quiz_from_file(const char *path, Question *out, int max_out) {
-#ifdef _WIN32
-    /* On Windows, try to open with UTF-8 encoding */
-    FILE *fp = NULL;
-    /* Try with explicit UTF-8 mode (Windows-specific) */
-    #ifdef __MINGW32__
-        /* MinGW: use regular fopen, encoding handled by console */
-        fp = fopen(path, "r");
-    #else
-        /* MSVC: try UTF-8 mode */
-        if (fopen_s(&fp, path, "r, ccs=UTF-8") != 0) {
-            fp = fopen(path, "r");
-        }
-    #endif
-#else
-    FILE *fp = fopen(path, "r");
-#endif
+    /* Binary mode on every platform: the UTF-8 bytes go to the console
+       unchanged, trim_newline drops the '\r' of Windows line endings,
+       and file positions are plain byte offsets. */
+    FILE *fp = fopen(path, "rb");
     if (!fp) return 0;
     
     char line[MAX_TEXT];
+    int have_next = 0; /* line already holds the next question's first line */
+    long pos = 0;      /* byte offset of the next unread byte */
     int count = 0;
     while (count < max_out) {
         char q[MAX_TEXT] = {0};
         char opt[4][MAX_TEXT] = {{0}};
         char ans_line[MAX_TEXT] = {0};
-        char expl[MAX_TEXT] = {0};
 
         /* Read question (skip blank lines) */
-        while (fgets(line, sizeof(line), fp)) {
+        if (have_next) {
+            strncpy(q, line, sizeof(q)-1);
+            have_next = 0;
+        }
+        while (q[0] == '\0' && read_counted(line, sizeof(line), fp, &pos)) {
             trim_newline(line);
             if (line[0] == '\0') continue;
             strncpy(q, line, sizeof(q)-1);
-            break;
         }
         if (q[0] == '\0') break; /* no more */
 
         /* Read 4 options */
         int ok = 1;
         for (int i = 0; i < 4; i++) {
-            if (!fgets(line, sizeof(line), fp)) { ok = 0; break; }
+            if (!read_counted(line, sizeof(line), fp, &pos)) { ok = 0; break; }
             trim_newline(line);
             strncpy(opt[i], line, sizeof(opt[i])-1);
         }
 
         /* Read answer line */
         if (ok) {
-            if (!fgets(ans_line, sizeof(ans_line), fp)) ok = 0;
+            if (!read_counted(ans_line, sizeof(ans_line), fp, &pos)) ok = 0;
             else trim_newline(ans_line);
         }
         
-        /* Note: Quiz files don't contain explanations - they're only in fallback quizzes */
-        
+        /* Optional metadata lines after the answer */
+        uint64_t topics = 0;
+        int difficulty = 0;
+        long expl_offset = 0;
+        int expl_length = 0;
+        while (ok) {
+            long before = pos;
+            if (!read_counted(line, sizeof(line), fp, &pos)) break;
+            int line_done = strchr(line, '\n') != NULL; /* else fgets split a long line */
+            trim_newline(line);
+            if (line[0] == '\0') continue;
+            if (strncmp(line, "Tags:", 5) == 0) {
+                topics |= parse_tags(line + 5);
+            } else if (strncmp(line, "Difficulty:", 11) == 0) {
+                difficulty = atoi(line + 11);
+                if (difficulty < 0 || difficulty > 5) difficulty = 0;
+            } else if (strncmp(line, "Explanation:", 12) == 0) {
+                /* Only remember where the text is; it can be long and is
+                   read on demand. It runs until a blank line, so it must
+                   be the last metadata of the question. */
+                const char *text = line + 12;
+                while (*text == ' ') text++;
+                expl_offset = before + (long)(text - line);
+                long end = pos;
+                while (read_counted(line, sizeof(line), fp, &pos)) {
+                    int was_done = line_done;
+                    line_done = strchr(line, '\n') != NULL;
+                    trim_newline(line);
+                    if (was_done && line[0] == '\0') break;
+                    end = pos;
+                }
+                expl_length = (int)(end - expl_offset);
+                break;
+            } else {
+                have_next = 1; /* next question: keep the line for the next round */
+                break;
+            }
+        }
+
         if (!ok) break;
 
         int ans = atoi(ans_line); /* expects 1..4 */
@@ -73,13 +152,95 @@ int load_quiz_from_file(const char *path, Question *out, int max_out) {
             strncpy(out[count].options[i], opt[i], sizeof(out[count].options[i])-1);
         }
         out[count].correctIndex = ans - 1;
-        strncpy(out[count].explanation, expl, sizeof(out[count].explanation)-1);
+        out[count].explanation = NULL;
+        out[count].topics = topics;
+        out[count].difficulty = difficulty;
+        out[count].expl_file = expl_length > 0 ? path : NULL;
+        out[count].expl_offset = expl_offset;
+        out[count].expl_length = expl_length;
         count++;
     }
     fclose(fp);
     return count;
 }
 
+/* Explanation text for a question (inline or read from its quiz file);
+   caller frees. NULL if the question has none. */
+char *load_explanation(const Question *q) {
+    if (q->explanation && q->explanation[0] != '\0') {
+        size_t n = strlen(q->explanation);
+        char *copy = malloc(n + 1);
+        if (copy) memcpy(copy, q->explanation, n + 1);
+        return copy;
+    }
+    if (!q->expl_file || q->expl_length <= 0) return NULL;
+
+    FILE *fp = fopen(q->expl_file, "rb");
+    if (!fp) return NULL;
+    char *text = malloc((size_t)q->expl_length + 1);
+    size_t got = 0;
+    if (text && fseek(fp, q->expl_offset, SEEK_SET) == 0) {
+        got = fread(text, 1, (size_t)q->expl_length, fp);
+    }
+    fclose(fp);
+    if (!text) return NULL;
+
+    /* Drop '\r' (files saved on Windows) and the final newline */
+    size_t n = 0;
+    for (size_t i = 0; i < got; i++) {
+        if (text[i] != '\r') text[n++] = text[i];
+    }
+    text[n] = '\0';
+    trim_newline(text);
+    if (text[0] == '\0') {
+        free(text);
+        return NULL;
+    }
+    return text;
+}
+
+/* Canonical form of a comma-separated chapter list: spaces trimmed,
+   duplicates dropped, codes sorted ("LIM, DER,LIM" -> "DER,LIM").
+   Returns the number of codes written to out. */
+int canonical_chapters(const char *codes, char *out, int out_size) {
+    char list[MAX_LIST_CODES][8];
+    int count = 0;
+    const char *p = codes;
+    while (*p) {
+        while (*p == ' ' || *p == '\t') p++;
+        char code[8] = {0};
+        int len = 0;
+        while (*p && *p != ',') {
+            if (len < 7) code[len++] = *p;
+            p++;
+        }
+        if (*p == ',') p++;
+        while (len > 0 && (code[len-1] == ' ' || code[len-1] == '\t')) code[--len] = '\0';
+        if (len == 0) continue;
+
+        /* Insert in sorted position, skipping duplicates */
+        int at = 0;
+        while (at < count && strcmp(list[at], code) < 0) at++;
+        if (at < count && strcmp(list[at], code) == 0) continue;
+        if (count == MAX_LIST_CODES) break;
+        memmove(list[at + 1], list[at], (size_t)(count - at) * sizeof(list[0]));
+        strcpy(list[at], code);
+        count++;
+    }
+
+    int used = 0, written = 0;
+    if (out_size > 0) out[0] = '\0';
+    for (int i = 0; i < count; i++) {
+        int len = (int)strlen(list[i]);
+        if (used + (i > 0) + len >= out_size) break; /* keep whole codes only */
+        if (i > 0) out[used++] = ',';
+        memcpy(out + used, list[i], (size_t)len + 1);
+        used += len;
+        written++;
+    }
+    return written;
+}
+
 /* Fallback quiz for each chapter; returns count */
 int fallback_quiz(const Chapter *chap, Question *out, int max_out) {
     int count = 0;
@@ -88,19 +249,19 @@ int fallback_quiz(const Chapter *chap, Question *out, int max_out) {
         Question q[] = {
             {"lim_{x->2} (x^2 - 4)/(x - 2) = ?",
              {"2", "4", "6", "Does not exist"}, 1,
-             "Factor the numerator: x^2 - 4 = (x-2)(x+2). Cancel (x-2) to get lim_{x->2} (x+2) = 4."},
+             "Factor the numerator: x^2 - 4 = (x-2)(x+2). Cancel (x-2) to get lim_{x->2} (x+2) = 4.", 0, 2, NULL, 0, 0},
             {"If lim_{x->a} f(x) = L, this means?",
              {"f(a)=L definitely", "f(x) approaches L as x approaches a", "f(x)=L for all x", "None of the above"}, 1,
-             "A limit describes the behavior of f(x) as x approaches a, not necessarily the value at a. The limit can exist even if f(a) is undefined."},
+             "A limit describes the behavior of f(x) as x approaches a, not necessarily the value at a. The limit can exist even if f(a) is undefined.", 0, 1, NULL, 0, 0},
             {"For 0/0 cases, we usually use?",
              {"Direct substitution", "Factoring/multiplying by conjugate", "Change variable to t", "Conclude limit does not exist"}, 1,
-             "When direct substitution gives 0/0, we use algebraic manipulation like factoring or multiplying by the conjugate to simplify the expression."},
+             "When direct substitution gives 0/0, we use algebraic manipulation like factoring or multiplying by the conjugate to simplify the expression.", 0, 1, NULL, 0, 0},
             {"lim_{x->0} sin x / x = ?",
              {"0", "1", "Cannot be determined", "Depends on direction"}, 1,
-             "This is a fundamental limit. Using L'Hospital's rule or geometric arguments, lim_{x->0} sin(x)/x = 1."},
+             "This is a fundamental limit. Using L'Hospital's rule or geometric arguments, lim_{x->0} sin(x)/x = 1.", 0, 2, NULL, 0, 0},
             {"lim_{x->∞} 1/x = ?",
              {"0", "1", "∞", "Undefined"}, 0,
-             "As x becomes very large, 1/x becomes very small and approaches 0. This is a basic limit at infinity."}
+             "As x becomes very large, 1/x becomes very small and approaches 0. This is a basic limit at infinity.", 0, 1, NULL, 0, 0}
         };
         int n = (int)(sizeof(q)/sizeof(q[0]));
         for (int i = 0; i < n && count < max_out; i++) out[count++] = q[i];
@@ -108,19 +269,19 @@ int fallback_quiz(const Chapter *chap, Question *out, int max_out) {
         Question q[] = {
             {"The definition of f'(x) is?",
              {"Average slope", "lim_{h->0} (f(x+h)-f(x))/h", "Second derivative", "Integral of f"}, 1,
-             "The derivative is defined as the limit of the difference quotient: f'(x) = lim_{h->0} (f(x+h)-f(x))/h, which gives the instantaneous rate of change."},
+             "The derivative is defined as the limit of the difference quotient: f'(x) = lim_{h->0} (f(x+h)-f(x))/h, which gives the instantaneous rate of change.", 0, 1, NULL, 0, 0},
             {"d/dx [x^3] = ?",
              {"3x^2", "x^2", "3x", "x^3"}, 0,
-             "Using the power rule: d/dx [x^n] = n*x^(n-1). For x^3, we get 3*x^(3-1) = 3x^2."},
+             "Using the power rule: d/dx [x^n] = n*x^(n-1). For x^3, we get 3*x^(3-1) = 3x^2.", 0, 1, NULL, 0, 0},
             {"(fg)' = ?",
              {"f'g'", "f'g + fg'", "f'g - fg'", "f'g / fg'"}, 1,
-             "The product rule states that the derivative of a product is: (fg)' = f'g + fg'. This is different from the derivative of a sum."},
+             "The product rule states that the derivative of a product is: (fg)' = f'g + fg'. This is different from the derivative of a sum.", 0, 2, NULL, 0, 0},
             {"d/dx [sin x] = ?",
              {"cos x", "-cos x", "sin x", "-sin x"}, 0,
-             "The derivative of sin(x) is cos(x). This is a fundamental trigonometric derivative that should be memorized."},
+             "The derivative of sin(x) is cos(x). This is a fundamental trigonometric derivative that should be memorized.", 0, 1, NULL, 0, 0},
             {"Chain rule is used when?",
              {"Constant function", "Composite function g(h(x))", "Second derivative", "Inverse function"}, 1,
-             "The chain rule is used to differentiate composite functions. If y = g(h(x)), then dy/dx = g'(h(x)) * h'(x)."}
+             "The chain rule is used to differentiate composite functions. If y = g(h(x)), then dy/dx = g'(h(x)) * h'(x).", 0, 2, NULL, 0, 0}
         };
         int n = (int)(sizeof(q)/sizeof(q[0]));
         for (int i = 0; i < n && count < max_out; i++) out[count++] = q[i];
@@ -128,13 +289,13 @@ int fallback_quiz(const Chapter *chap, Question *out, int max_out) {
         Question q[] = {
             {"How is optimization done?",
              {"Guess", "Find derivative and critical points", "Always integrate", "Use limits only"}, 1,
-             "Optimization involves finding the derivative, setting it to zero to find critical points, and testing these points to determine maxima or minima."},
+             "Optimization involves finding the derivative, setting it to zero to find critical points, and testing these points to determine maxima or minima.", 0, 2, NULL, 0, 0},
             {"Instantaneous velocity is?",
              {"Displacement/time", "Derivative of position with respect to time", "Acceleration", "Constant"}, 1,
-             "Instantaneous velocity is the derivative of the position function with respect to time: v(t) = ds/dt. It represents the velocity at a specific moment."},
+             "Instantaneous velocity is the derivative of the position function with respect to time: v(t) = ds/dt. It represents the velocity at a specific moment.", 0, 1, NULL, 0, 0},
             {"Maximum-minimum points are tested with?",
              {"Average value", "Second derivative/test endpoints", "Integral", "Limit"}, 1,
-             "To find maximum and minimum values, we test critical points using the second derivative test or by evaluating the function at critical points and endpoints."}
+             "To find maximum and minimum values, we test critical points using the second derivative test or by evaluating the function at critical points and endpoints.", 0, 2, NULL, 0, 0}
         };
         int n = (int)(sizeof(q)/sizeof(q[0]));
         for (int i = 0; i < n && count < max_out; i++) out[count++] = q[i];
@@ -152,3 +313,58 @@ void shuffle_indices(int *idx, int n) {
     }
 }
 
+static uint32_t rng_next(Rng *r) {
+    uint64_t old = r->state;
+    r->state = old * 6364136223846793005ULL + r->inc;
+    uint32_t xorshifted = (uint32_t)(((old >> 18u) ^ old) >> 27u);
+    uint32_t rot = (uint32_t)(old >> 59u);
+    return (xorshifted >> rot) | (xorshifted << ((32u - rot) & 31u));
+}
+
+/* Seed a stream; same (seed, stream) always gives the same sequence */
+void rng_seed(Rng *r, uint64_t seed, uint64_t stream) {
+    r->state = 0;
+    r->inc = (stream << 1u) | 1u;
+    rng_next(r);
+    r->state += seed;
+    rng_next(r);
+}
+
+/* Uniform integer in [0, n) */
+uint32_t rng_below(Rng *r, uint32_t n) {
+    if (n == 0) return 0;
+    uint32_t limit = (uint32_t)(-n) % n; /* reject the biased low values */
+    uint32_t x;
+    do {
+        x = rng_next(r);
+    } while (x < limit);
+    return x % n;
+}
+
+/* Shuffle indices using a given stream */
+void shuffle_indices_rng(int *idx, int n, Rng *r) {
+    for (int i = n - 1; i > 0; i--) {
+        int j = (int)rng_below(r, (uint32_t)(i + 1));
+        int t = idx[i];
+        idx[i] = idx[j];
+        idx[j] = t;
+    }
+}
+
+/* Shuffle the 4 options of a question, remapping correctIndex */
+void shuffle_options(Question *q, Rng *r) {
+    int perm[4] = {0, 1, 2, 3};
+    shuffle_indices_rng(perm, 4, r);
+    char moved[4][MAX_TEXT];
+    memcpy(moved, q->options, sizeof(moved));
+    int old_correct = q->correctIndex;
+    for (int i = 0; i < 4; i++) {
+        memcpy(q->options[i], moved[perm[i]], MAX_TEXT);
+        if (perm[i] == old_correct) q->correctIndex = i;
+    }
+}
+
+/* Stable question id (hash of the prompt), used by the stats store */
+uint64_t question_id(const Question *q) {
+    return hash_string(q->prompt);
+}
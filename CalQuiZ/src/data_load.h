@@ -2,16 +2,54 @@
 #define DATA_LOAD_H
 
 #include "data_structs.h"
+#include <stdint.h>
 
 /* Parse quiz file into Question array; return count loaded */
-/* Format: question, 4 options, answer (1-4) */
+/* Format: question, 4 options, answer (1-4), optional Tags:/Difficulty:/Explanation: lines */
+/* path must outlive the questions (explanations are read from it later) */
 int load_quiz_from_file(const char *path, Question *out, int max_out);
 
+/* Topic tag -> bit index (registered on first use); -1 if the table is full */
+int topic_id(const char *name);
+
+/* Bit index -> topic tag ("" if unknown) */
+const char *topic_name(int id);
+
+/* Explanation text for a question (inline or read from its quiz file);
+   caller frees. NULL if the question has none. */
+char *load_explanation(const Question *q);
+
+/* Canonical form of a comma-separated chapter list: spaces trimmed,
+   duplicates dropped, codes sorted ("LIM, DER,LIM" -> "DER,LIM").
+   Returns the number of codes written to out. */
+int canonical_chapters(const char *codes, char *out, int out_size);
+
 /* Fallback quiz for each chapter; returns count */
 int fallback_quiz(const Chapter *chap, Question *out, int max_out);
 
 /* Shuffle indices */
 void shuffle_indices(int *idx, int n);
 
+/* Independent random stream (PCG32) so threads don't share rand() */
+typedef struct {
+    uint64_t state;
+    uint64_t inc; /* stream selector, always odd */
+} Rng;
+
+/* Seed a stream; same (seed, stream) always gives the same sequence */
+void rng_seed(Rng *r, uint64_t seed, uint64_t stream);
+
+/* Uniform integer in [0, n) */
+uint32_t rng_below(Rng *r, uint32_t n);
+
+/* Shuffle indices using a given stream */
+void shuffle_indices_rng(int *idx, int n, Rng *r);
+
+/* Shuffle the 4 options of a question, remapping correctIndex */
+void shuffle_options(Question *q, Rng *r);
+
+/* Stable question id (hash of the prompt), used by the stats store */
+uint64_t question_id(const Question *q);
+
 #endif /* DATA_LOAD_H */
 
@@ -1,14 +1,26 @@
 #ifndef DATA_STRUCTS_H
 #define DATA_STRUCTS_H
 
+#include <stdint.h>
+
 #define MAX_QUESTIONS 64
 #define MAX_TEXT 512
+#define MAX_TOPICS 64 /* topic tags fit in one 64-bit set */
+#define MAX_CHAPTER_LIST 32 /* chapter code or sorted list such as "DER,LIM" */
+#define MAX_LIST_CODES 16 /* chapter codes kept by canonical_chapters */
 
 typedef struct {
     char prompt[MAX_TEXT];
     char options[4][MAX_TEXT];
     int correctIndex; /* 0..3 */
-    char explanation[MAX_TEXT]; /* Explanation for the answer */
+    const char *explanation; /* Inline explanation (sample quizzes); NULL if none */
+    uint64_t topics; /* bit i set = tagged with topic_name(i); 0 = untagged */
+    int difficulty; /* 1 (easy) .. 5 (hard); 0 = not rated */
+    /* Explanation stored in a quiz file: only its location is kept,
+       the text is read on demand by load_explanation() */
+    const char *expl_file; /* NULL if none */
+    long expl_offset;
+    int expl_length;
 } Question;
 
 typedef struct {
@@ -0,0 +1,210 @@
+#include "exam_builder.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define COVER_WEIGHT 4.0  /* one newly covered topic outweighs any difficulty drift */
+#define REUSE_PENALTY 0.25 /* spread picks over buckets once topics are covered */
+#define RANDOM_PROBES 4   /* random tries before scanning a bucket for an unused question */
+
+static int popcount64(uint64_t x) {
+#if defined(__GNUC__)
+    return __builtin_popcountll(x);
+#else
+    int n = 0;
+    while (x) {
+        x &= x - 1;
+        n++;
+    }
+    return n;
+#endif
+}
+
+/* Index of the lowest set bit (x != 0) */
+static int lowest_bit(uint64_t x) {
+#if defined(__GNUC__)
+    return __builtin_ctzll(x);
+#else
+    int n = 0;
+    while (!(x & 1)) {
+        x >>= 1;
+        n++;
+    }
+    return n;
+#endif
+}
+
+static int clamp_level(int difficulty) {
+    return difficulty >= 0 && difficulty < EXAM_LEVELS ? difficulty : 0;
+}
+
+/* Bucket the bank (O(n * tags per question)). Build once per bank load
+   and reuse it for every exam drawn from that bank. */
+int exam_index_build(ExamIndex *ix, const Question *bank, int n) {
+    memset(ix, 0, sizeof(*ix));
+    ix->bank_count = n;
+
+    /* Pass 1: bucket sizes */
+    int count[EXAM_BUCKETS] = {0};
+    int total = 0;
+    int rated = 0;
+    double difficulty_sum = 0.0;
+    for (int i = 0; i < n; i++) {
+        int level = clamp_level(bank[i].difficulty);
+        uint64_t t = bank[i].topics;
+        if (t == 0) {
+            count[MAX_TOPICS * EXAM_LEVELS + level]++;
+            total++;
+        }
+        while (t) {
+            int bit = lowest_bit(t);
+            count[bit * EXAM_LEVELS + level]++;
+            total++;
+            t &= t - 1;
+        }
+        ix->all_topics |= bank[i].topics;
+        if (level > 0) {
+            rated++;
+            difficulty_sum += level;
+        }
+    }
+    ix->avg_difficulty = rated ? difficulty_sum / rated : 0.0;
+
+    ix->topics = malloc((size_t)(n + 1) * sizeof(*ix->topics));
+    ix->level = malloc((size_t)(n + 1));
+    ix->members = malloc((size_t)(total + 1) * sizeof(*ix->members));
+    if (!ix->topics || !ix->level || !ix->members) {
+        exam_index_free(ix);
+        return 0;
+    }
+
+    /* Pass 2: lay members out bucket by bucket */
+    int at = 0;
+    for (int b = 0; b < EXAM_BUCKETS; b++) {
+        ix->start[b] = at;
+        if (count[b] > 0) ix->active[ix->active_count++] = b;
+        at += count[b];
+        count[b] = 0;
+    }
+    ix->start[EXAM_BUCKETS] = at;
+    for (int i = 0; i < n; i++) {
+        int level = clamp_level(bank[i].difficulty);
+        uint64_t t = bank[i].topics;
+        ix->topics[i] = t;
+        ix->level[i] = (unsigned char)level;
+        if (t == 0) {
+            int b = MAX_TOPICS * EXAM_LEVELS + level;
+            ix->members[ix->start[b] + count[b]++] = i;
+        }
+        while (t) {
+            int b = lowest_bit(t) * EXAM_LEVELS + level;
+            ix->members[ix->start[b] + count[b]++] = i;
+            t &= t - 1;
+        }
+    }
+    return 1;
+}
+
+/* Release index memory */
+void exam_index_free(ExamIndex *ix) {
+    free(ix->topics);
+    free(ix->level);
+    free(ix->members);
+    memset(ix, 0, sizeof(*ix));
+}
+
+/* A random unused member of bucket b, or -1 if all are used. Random
+   probes find one in O(1) while the bucket is mostly unused; the scan
+   only runs once most of it has been taken. */
+static int draw_member(const ExamIndex *ix, int b, const unsigned char *used, Rng *rng) {
+    int first = ix->start[b];
+    int size = ix->start[b + 1] - first;
+    for (int k = 0; k < RANDOM_PROBES; k++) {
+        int q = ix->members[first + (int)rng_below(rng, (uint32_t)size)];
+        if (!used[q]) return q;
+    }
+    int at = (int)rng_below(rng, (uint32_t)size);
+    for (int k = 0; k < size; k++) {
+        int q = ix->members[first + (at + k) % size];
+        if (!used[q]) return q;
+    }
+    return -1;
+}
+
+/* Greedy pick of `want` questions: cover required topics first (bitset
+   gain), then keep the running average difficulty near the target.
+   A NULL spec means every topic in the bank at its average difficulty.
+   used has one byte per bank question; nonzero entries are skipped and
+   every pick is marked, so callers can exclude questions up front.
+   rank (may be NULL) gives each question's priority, lower is preferred.
+   Each bucket keeps one candidate until it is taken, so a pick costs
+   O(EXAM_BUCKETS), not O(bank size).
+   Writes question indices to out; returns how many were picked. */
+int exam_pick(const ExamIndex *ix, int want, const ExamSpec *spec, const int *rank,
+              Rng *rng, unsigned char *used, int *out) {
+    uint64_t need = spec ? spec->required_topics : ix->all_topics; /* NULL spec: every topic */
+    double target = spec && spec->target_difficulty > 0.0 ? spec->target_difficulty : ix->avg_difficulty;
+
+    int taken[EXAM_BUCKETS] = {0};  /* picks per bucket in this exam */
+    char empty[EXAM_BUCKETS] = {0}; /* no unused members left */
+    int cand[EXAM_BUCKETS];         /* current candidate per bucket, -1 = none */
+    for (int a = 0; a < ix->active_count; a++) cand[ix->active[a]] = -1;
+    uint64_t covered = 0;
+    double difficulty_sum = 0.0;
+    int rated = 0;
+    int picked = 0;
+    while (picked < want) {
+        int best = -1;
+        double best_score = 0.0;
+        for (int a = 0; a < ix->active_count; a++) {
+            int b = ix->active[a];
+            if (empty[b]) continue;
+            int q = cand[b];
+            if (q < 0 || used[q]) {
+                /* Draw a new candidate only once the old one is taken */
+                q = draw_member(ix, b, used, rng);
+                if (q < 0) {
+                    empty[b] = 1;
+                    continue;
+                }
+                /* With priorities, take the better of two draws */
+                if (rank) {
+                    int other = draw_member(ix, b, used, rng);
+                    if (rank[other] < rank[q]) q = other;
+                }
+                cand[b] = q;
+            }
+
+            double score = COVER_WEIGHT * popcount64(ix->topics[q] & need & ~covered);
+            int level = ix->level[q];
+            if (target > 0.0 && level > 0) {
+                double avg = (difficulty_sum + level) / (rated + 1);
+                score -= avg > target ? avg - target : target - avg;
+            }
+            score -= REUSE_PENALTY * taken[b];
+
+            /* Ties go to the higher-priority question */
+            if (best < 0 || score > best_score ||
+                (score == best_score && rank && rank[q] < rank[best])) {
+                best = q;
+                best_score = score;
+            }
+        }
+        if (best < 0) break; /* bank exhausted */
+
+        int level = ix->level[best];
+        uint64_t t = ix->topics[best];
+        used[best] = 1;
+        out[picked++] = best;
+        covered |= t;
+        if (t == 0) taken[MAX_TOPICS * EXAM_LEVELS + level]++;
+        while (t) {
+            taken[lowest_bit(t) * EXAM_LEVELS + level]++;
+            t &= t - 1;
+        }
+        if (level > 0) {
+            difficulty_sum += level;
+            rated++;
+        }
+    }
+    return picked;
+}
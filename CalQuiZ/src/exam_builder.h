@@ -0,0 +1,51 @@
+#ifndef EXAM_BUILDER_H
+#define EXAM_BUILDER_H
+
+#include <stdint.h>
+#include "data_structs.h"
+#include "data_load.h"
+
+/* What a generated exam must satisfy */
+typedef struct {
+    uint64_t required_topics;  /* each topic must appear at least once; 0 = none */
+    double target_difficulty;  /* aim for this average difficulty; 0 = bank average */
+} ExamSpec;
+
+#define EXAM_TOPIC_ROWS (MAX_TOPICS + 1) /* one row per tag bit, last row = untagged */
+#define EXAM_LEVELS 6                    /* difficulty 0 (unrated) .. 5 */
+#define EXAM_BUCKETS (EXAM_TOPIC_ROWS * EXAM_LEVELS)
+
+/* Questions bucketed by (tag, difficulty). A question with three tags
+   sits in three buckets, so "who covers topic t" is one lookup. */
+typedef struct {
+    uint64_t *topics;            /* per question, copied so picks stay in cache */
+    unsigned char *level;        /* per question difficulty, 0 = unrated */
+    int bank_count;
+    int *members;                /* question indices, bucket by bucket */
+    int start[EXAM_BUCKETS + 1]; /* bucket b = members[start[b] .. start[b+1]) */
+    int active[EXAM_BUCKETS];    /* non-empty buckets */
+    int active_count;
+    uint64_t all_topics;
+    double avg_difficulty;       /* over rated questions only */
+} ExamIndex;
+
+/* Bucket the bank (O(n * tags per question)). Build once per bank load
+   and reuse it for every exam drawn from that bank. */
+int exam_index_build(ExamIndex *ix, const Question *bank, int n);
+
+/* Release index memory */
+void exam_index_free(ExamIndex *ix);
+
+/* Greedy pick of `want` questions: cover required topics first (bitset
+   gain), then keep the running average difficulty near the target.
+   A NULL spec means every topic in the bank at its average difficulty.
+   used has one byte per bank question; nonzero entries are skipped and
+   every pick is marked, so callers can exclude questions up front.
+   rank (may be NULL) gives each question's priority, lower is preferred.
+   Each bucket keeps one candidate until it is taken, so a pick costs
+   O(EXAM_BUCKETS), not O(bank size).
+   Writes question indices to out; returns how many were picked. */
+int exam_pick(const ExamIndex *ix, int want, const ExamSpec *spec, const int *rank,
+              Rng *rng, unsigned char *used, int *out);
+
+#endif /* EXAM_BUILDER_H */
@@ -0,0 +1,367 @@
+#include "grading.h"
+#include "data_load.h"
+#include "logging.h"
+#include "log_analytics.h"
+#include "utils.h"
+#include "hashmap.h"
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define HAVE_SSE2 1
+#endif
+
+#define MAX_ANSWERS 1024      /* longest answer vector on a sheet */
+#define MAX_SHEET_LINE 8192   /* fits MAX_ANSWERS as "1, 2, ..." plus the name */
+#define LOG_BATCH 4096        /* results per log_test_results call */
+#define MAX_PATH_LEN 512
+#define MAX_PAPER 100000
+
+/* Answer key of one paper, padded to a multiple of 16 bytes */
+typedef struct {
+    int paper;
+    int loaded;               /* 0 = not tried, 1 = ok, -1 = missing */
+    char chapters[MAX_CHAPTER_LIST]; /* canonical list, logged as the chapter code */
+    int count;
+    unsigned char answers[MAX_ANSWERS + 16];
+    long long *question_correct; /* class summary: students right per question */
+    long long sheets;
+    long long score_sum;
+} PaperKey;
+
+/* Keys of the papers seen so far, allocated on first use, so a stray
+   paper number costs one map slot instead of a dense array up to it */
+typedef struct {
+    HashMap index;   /* paper number -> slot in list */
+    PaperKey **list; /* NULL slot = no usable key file for that paper */
+    int count;
+    int cap;
+} KeyTable;
+
+#ifdef HAVE_SSE2
+static int popcount32(unsigned x) {
+#if defined(__GNUC__)
+    return __builtin_popcount(x);
+#else
+    int n = 0;
+    while (x) {
+        x &= x - 1;
+        n++;
+    }
+    return n;
+#endif
+}
+
+/* Index of the lowest set bit (x != 0) */
+static int lowest_bit(unsigned x) {
+#if defined(__GNUC__)
+    return __builtin_ctz(x);
+#else
+    int bit = 0;
+    while (!(x & 1u)) {
+        x >>= 1;
+        bit++;
+    }
+    return bit;
+#endif
+}
+#endif
+
+/* Compare a packed answer vector with the key, 16 answers per step.
+   Returns matches; per-question hits are added to question_correct. */
+static int compare_answers(const unsigned char *answers, const unsigned char *key, int count,
+                           long long *question_correct) {
+    int score = 0;
+    int i = 0;
+#ifdef HAVE_SSE2
+    for (; i + 16 <= count; i += 16) {
+        __m128i a = _mm_loadu_si128((const __m128i *)(answers + i));
+        __m128i k = _mm_loadu_si128((const __m128i *)(key + i));
+        unsigned mask = (unsigned)_mm_movemask_epi8(_mm_cmpeq_epi8(a, k));
+        score += popcount32(mask);
+        while (mask) {
+            question_correct[i + lowest_bit(mask)]++;
+            mask &= mask - 1;
+        }
+    }
+#endif
+    for (; i < count; i++) {
+        if (answers[i] == key[i]) {
+            score++;
+            question_correct[i]++;
+        }
+    }
+    return score;
+}
+
+/* Read key_dir/key_NNN.txt ("Chapters:" and "Answers:" lines) */
+static void load_key(const char *key_dir, int paper, PaperKey *k) {
+    k->loaded = -1;
+    char path[MAX_PATH_LEN];
+    snprintf(path, sizeof(path), "%s/key_%03d.txt", key_dir, paper);
+    FILE *fp = fopen(path, "r");
+    if (!fp) return;
+
+    char line[MAX_SHEET_LINE];
+    strcpy(k->chapters, "PAPER");
+    k->count = 0;
+    while (fgets(line, sizeof(line), fp)) {
+        trim_newline(line);
+        if (strncmp(line, "Chapters: ", 10) == 0) {
+            /* "LIM, DER" and "DER,LIM" must log as the same chapter code */
+            if (canonical_chapters(line + 10, k->chapters, (int)sizeof(k->chapters)) == 0) {
+                strcpy(k->chapters, "PAPER");
+            }
+        } else if (strncmp(line, "Answers: ", 9) == 0) {
+            const char *a = line + 9;
+            while (*a >= '1' && *a <= '4' && k->count < MAX_ANSWERS) {
+                k->answers[k->count++] = (unsigned char)*a++;
+            }
+        }
+    }
+    fclose(fp);
+    if (k->count == 0) return;
+
+    k->question_correct = calloc((size_t)k->count, sizeof(*k->question_correct));
+    if (!k->question_correct) return;
+    k->loaded = 1;
+}
+
+/* Split "user,paper,answers"; returns 0 for blank, comment or bad lines */
+static int parse_sheet_line(char *line, char **user, int *paper, char **answers) {
+    if (line[0] == '\0' || line[0] == '#') return 0;
+    char *c1 = strchr(line, ',');
+    if (!c1) return 0;
+    char *c2 = strchr(c1 + 1, ',');
+    if (!c2) return 0;
+    *c1 = '\0';
+    *c2 = '\0';
+    /* " alice " and "alice" are the same student */
+    while (*line == ' ' || *line == '\t') line++;
+    for (char *e = c1; e > line && (e[-1] == ' ' || e[-1] == '\t'); e--) e[-1] = '\0';
+    *user = line;
+    *paper = atoi(c1 + 1);
+    *answers = c2 + 1;
+    return **user != '\0' && *paper > 0 && *paper < MAX_PAPER;
+}
+
+static int cmp_int(const void *a, const void *b) {
+    int x = *(const int *)a, y = *(const int *)b;
+    return (x > y) - (x < y);
+}
+
+/* Per-student percentages (tenths) for median and spread */
+typedef struct {
+    int *pct10;
+    int count;
+    int cap;
+} ScoreList;
+
+static void score_list_add(ScoreList *s, int pct10) {
+    if (s->count == s->cap) {
+        int cap = s->cap ? s->cap * 2 : 1024;
+        int *grown = realloc(s->pct10, (size_t)cap * sizeof(*grown));
+        if (!grown) return;
+        s->pct10 = grown;
+        s->cap = cap;
+    }
+    s->pct10[s->count++] = pct10;
+}
+
+/* Key for a paper number, loading it on first use; NULL if it has no key */
+static PaperKey *find_key(KeyTable *t, const char *key_dir, int paper) {
+    int i = hashmap_get(&t->index, (uint64_t)paper);
+    if (i >= 0) return t->list[i];
+
+    if (t->count == t->cap) {
+        int cap = t->cap ? t->cap * 2 : 64;
+        PaperKey **grown = realloc(t->list, (size_t)cap * sizeof(*grown));
+        if (!grown) return NULL;
+        t->list = grown;
+        t->cap = cap;
+    }
+    PaperKey *k = calloc(1, sizeof(*k));
+    if (!k) return NULL;
+    k->paper = paper;
+    load_key(key_dir, paper, k);
+    if (k->loaded != 1) {
+        free(k->question_correct);
+        free(k);
+        k = NULL;
+    }
+    if (!hashmap_put(&t->index, (uint64_t)paper, t->count)) {
+        if (k) free(k->question_correct);
+        free(k);
+        return NULL;
+    }
+    t->list[t->count++] = k;
+    return k;
+}
+
+static int cmp_paper(const void *a, const void *b) {
+    int x = (*(PaperKey *const *)a)->paper, y = (*(PaperKey *const *)b)->paper;
+    return (x > y) - (x < y);
+}
+
+static void write_summary(FILE *out, PaperKey **keys, int key_count, ScoreList *scores, long long skipped) {
+    fprintf(out, "=== Class Summary ===\n");
+    fprintf(out, "Sheets graded: %d", scores->count);
+    if (skipped > 0) fprintf(out, " (%lld lines skipped)", skipped);
+    fprintf(out, "\n");
+    if (scores->count == 0) return;
+
+    qsort(scores->pct10, (size_t)scores->count, sizeof(int), cmp_int);
+    double sum = 0.0;
+    int passes = 0;
+    for (int i = 0; i < scores->count; i++) {
+        double p = scores->pct10[i] / 10.0;
+        sum += p;
+        if (p >= PASS_PERCENT) passes++;
+    }
+    double mean = sum / scores->count;
+    int mid = scores->count / 2;
+    double median = scores->count % 2 ? scores->pct10[mid] / 10.0
+                                      : (scores->pct10[mid - 1] + scores->pct10[mid]) / 20.0;
+
+    fprintf(out, "Average: %.1f%% | Median: %.1f%% | Min: %.1f%% | Max: %.1f%%\n",
+            mean, median, scores->pct10[0] / 10.0, scores->pct10[scores->count - 1] / 10.0);
+    fprintf(out, "Pass rate (>= %.0f%%): %.1f%%\n", PASS_PERCENT, 100.0 * passes / scores->count);
+
+    /* Score distribution in 10% bands */
+    int bands[11] = {0};
+    for (int i = 0; i < scores->count; i++) bands[scores->pct10[i] / 100]++;
+    fprintf(out, "\nScore bands:\n");
+    for (int b = 0; b < 10; b++) {
+        int n = bands[b] + (b == 9 ? bands[10] : 0);
+        fprintf(out, "  %3d-%3d%%: %d\n", b * 10, b == 9 ? 100 : b * 10 + 9, n);
+    }
+
+    fprintf(out, "\nPer paper (%% of students correct per question):\n");
+    for (int p = 0; p < key_count; p++) {
+        PaperKey *k = keys[p];
+        if (k->sheets == 0) continue;
+        fprintf(out, "  Paper %03d: %lld sheets, average %.1f/%d\n   ",
+                k->paper, k->sheets, (double)k->score_sum / k->sheets, k->count);
+        for (int q = 0; q < k->count; q++) {
+            fprintf(out, " Q%d %.0f%%", q + 1, 100.0 * k->question_correct[q] / k->sheets);
+            if (q % 10 == 9 && q + 1 < k->count) fprintf(out, "\n   ");
+        }
+        fprintf(out, "\n");
+    }
+}
+
+/* Grade every sheet line in every file; see grading.h */
+int grade_sheets(const char *key_dir, char *sheet_files[], int file_count, FILE *out) {
+    KeyTable keys = {{0}, NULL, 0, 0};
+    TestResult *batch = malloc(LOG_BATCH * sizeof(*batch));
+    ScoreList scores = {NULL, 0, 0};
+    long long skipped = 0;
+    if (!batch || !hashmap_init(&keys.index, 64)) {
+        free(batch);
+        return 0;
+    }
+    int pending = 0;
+
+    unsigned char packed[MAX_ANSWERS + 16];
+    char line[MAX_SHEET_LINE];
+    for (int f = 0; f < file_count; f++) {
+        FILE *fp = fopen(sheet_files[f], "r");
+        if (!fp) {
+            fprintf(out, "Cannot open %s\n", sheet_files[f]);
+            continue;
+        }
+        while (fgets(line, sizeof(line), fp)) {
+            if (!strchr(line, '\n')) {
+                /* Longer than the buffer: skip the whole line rather than
+                   grading its tail as another sheet */
+                int c, more = 0;
+                while ((c = getc(fp)) != EOF && c != '\n') more = 1;
+                if (more) {
+                    skipped++;
+                    continue;
+                }
+            }
+            trim_newline(line);
+            char *user, *answers;
+            int paper;
+            if (!parse_sheet_line(line, &user, &paper, &answers)) {
+                if (line[0] != '\0' && line[0] != '#') skipped++;
+                continue;
+            }
+
+            PaperKey *k = find_key(&keys, key_dir, paper);
+            if (!k) {
+                skipped++;
+                continue;
+            }
+
+            /* Pack answers into bytes aligned with the key; blanks never match.
+               Either one string ("3142-2") or one CSV field per answer ("3,1,,2"). */
+            int n = 0;
+            if (strchr(answers, ',')) {
+                const char *a = answers;
+                while (n < k->count) {
+                    while (*a == ' ') a++;
+                    packed[n++] = (*a >= '1' && *a <= '4') ? (unsigned char)*a : 0;
+                    a = strchr(a, ',');
+                    if (!a) break;
+                    a++;
+                }
+            } else {
+                for (const char *a = answers; *a && n < k->count; a++) {
+                    if (*a == ' ' || *a == '\t') continue;
+                    packed[n++] = (*a >= '1' && *a <= '4') ? (unsigned char)*a : 0;
+                }
+            }
+            while (n < k->count) packed[n++] = 0;
+
+            int score = compare_answers(packed, k->answers, k->count, k->question_correct);
+            k->sheets++;
+            k->score_sum += score;
+            score_list_add(&scores, (score * 1000 + k->count / 2) / k->count);
+
+            TestResult *r = &batch[pending++];
+            strncpy(r->username, user, sizeof(r->username) - 1);
+            r->username[sizeof(r->username) - 1] = '\0';
+            strncpy(r->chap_code, k->chapters, sizeof(r->chap_code) - 1);
+            r->chap_code[sizeof(r->chap_code) - 1] = '\0';
+            r->score = score;
+            r->total = k->count;
+            if (pending == LOG_BATCH) {
+                log_test_results(batch, pending);
+                pending = 0;
+            }
+        }
+        fclose(fp);
+    }
+    if (pending > 0) log_test_results(batch, pending);
+
+    /* Papers with a key, in paper order for the summary */
+    int key_count = 0;
+    for (int i = 0; i < keys.count; i++) {
+        if (keys.list[i]) keys.list[key_count++] = keys.list[i];
+    }
+    if (key_count > 0) qsort(keys.list, (size_t)key_count, sizeof(*keys.list), cmp_paper);
+
+    write_summary(out, keys.list, key_count, &scores, skipped);
+    char path[MAX_PATH_LEN];
+    snprintf(path, sizeof(path), "%s/class_summary.txt", key_dir);
+    FILE *sf = fopen(path, "w");
+    if (sf) {
+        write_summary(sf, keys.list, key_count, &scores, skipped);
+        fclose(sf);
+        fprintf(out, "\nSummary saved to %s\n", path);
+    }
+
+    int graded = scores.count;
+    for (int p = 0; p < key_count; p++) {
+        free(keys.list[p]->question_correct);
+        free(keys.list[p]);
+    }
+    free(keys.list);
+    hashmap_free(&keys.index);
+    free(scores.pct10);
+    free(batch);
+    return graded;
+}
@@ -0,0 +1,18 @@
+#ifndef GRADING_H
+#define GRADING_H
+
+#include <stdio.h>
+
+/*
+ * Bulk grading of offline answer sheets.
+ * Sheet lines: username,paper_number,answers   e.g.  alice,7,3142-21
+ * or one CSV field per answer                  e.g.  alice,7,3,1,4,,2,1
+ * (answers are digits 1-4; '-', empty or anything else = unanswered;
+ *  lines starting with '#' are ignored). Keys are read from
+ * key_dir/key_NNN.txt as written by "CalQuiZ papers".
+ * Scores go to the score log; a class summary is written to
+ * key_dir/class_summary.txt and to out. Returns sheets graded.
+ */
+int grade_sheets(const char *key_dir, char *sheet_files[], int file_count, FILE *out);
+
+#endif /* GRADING_H */
@@ -0,0 +1,114 @@
+#include "hashmap.h"
+#include <stdlib.h>
+
+/* Final mixer (from splitmix64) so nearby keys spread over the table */
+static uint64_t mix64(uint64_t x) {
+    x ^= x >> 30;
+    x *= 0xbf58476d1ce4e5b9ULL;
+    x ^= x >> 27;
+    x *= 0x94d049bb133111ebULL;
+    x ^= x >> 31;
+    return x;
+}
+
+static int alloc_table(HashMap *m, size_t cap) {
+    m->keys = malloc(cap * sizeof(*m->keys));
+    m->vals = malloc(cap * sizeof(*m->vals));
+    if (!m->keys || !m->vals) {
+        free(m->keys);
+        free(m->vals);
+        m->keys = NULL;
+        m->vals = NULL;
+        return 0;
+    }
+    for (size_t i = 0; i < cap; i++) m->vals[i] = -1;
+    m->cap = cap;
+    m->count = 0;
+    return 1;
+}
+
+/* Initialise map sized for about `expected` keys; return 0 on allocation failure */
+int hashmap_init(HashMap *m, size_t expected) {
+    size_t cap = 16;
+    while (cap < expected * 2) cap <<= 1; /* keep load factor <= 0.5 */
+    return alloc_table(m, cap);
+}
+
+/* Release map memory */
+void hashmap_free(HashMap *m) {
+    free(m->keys);
+    free(m->vals);
+    m->keys = NULL;
+    m->vals = NULL;
+    m->cap = 0;
+    m->count = 0;
+}
+
+/* Look up key; return stored value or -1 if missing */
+int hashmap_get(const HashMap *m, uint64_t key) {
+    if (m->cap == 0) return -1;
+    size_t mask = m->cap - 1;
+    size_t i = (size_t)mix64(key) & mask;
+    while (m->vals[i] >= 0) {
+        if (m->keys[i] == key) return m->vals[i];
+        i = (i + 1) & mask;
+    }
+    return -1;
+}
+
+/* Double the table when it gets more than half full */
+static int grow(HashMap *m) {
+    HashMap bigger;
+    if (!alloc_table(&bigger, m->cap ? m->cap * 2 : 16)) return 0;
+    for (size_t i = 0; i < m->cap; i++) {
+        if (m->vals[i] >= 0) hashmap_put(&bigger, m->keys[i], m->vals[i]);
+    }
+    hashmap_free(m);
+    *m = bigger;
+    return 1;
+}
+
+/* Insert or overwrite key; return 0 on allocation failure */
+int hashmap_put(HashMap *m, uint64_t key, int val) {
+    if ((m->count + 1) * 2 > m->cap) {
+        if (!grow(m)) return 0;
+    }
+    size_t mask = m->cap - 1;
+    size_t i = (size_t)mix64(key) & mask;
+    while (m->vals[i] >= 0) {
+        if (m->keys[i] == key) {
+            m->vals[i] = val;
+            return 1;
+        }
+        i = (i + 1) & mask;
+    }
+    m->keys[i] = key;
+    m->vals[i] = val;
+    m->count++;
+    return 1;
+}
+
+/* 64-bit FNV-1a hash of a NUL-terminated string */
+uint64_t hash_string(const char *s) {
+    uint64_t h = 0xcbf29ce484222325ULL;
+    while (*s) {
+        h ^= (unsigned char)*s++;
+        h *= 0x100000001b3ULL;
+    }
+    return h;
+}
+
+/* Same hash over a byte range (not NUL-terminated) */
+uint64_t hash_bytes(const char *s, size_t len) {
+    uint64_t h = 0xcbf29ce484222325ULL;
+    for (size_t i = 0; i < len; i++) {
+        h ^= (unsigned char)s[i];
+        h *= 0x100000001b3ULL;
+    }
+    return h;
+}
+
+/* Mix two 64-bit hashes into one key */
+uint64_t hash_combine(uint64_t a, uint64_t b) {
+    return mix64(a ^ (b + 0x9e3779b97f4a7c15ULL + (a << 6) + (a >> 2)));
+}
@@ -0,0 +1,40 @@
+#ifndef HASHMAP_H
+#define HASHMAP_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Small open-addressing hash index: 64-bit key -> int value.
+ * Values are usually positions in a caller-owned record array,
+ * so the map itself stays compact (12 bytes per slot).
+ */
+typedef struct {
+    uint64_t *keys;
+    int *vals;      /* -1 marks an empty slot */
+    size_t cap;     /* always a power of two */
+    size_t count;
+} HashMap;
+
+/* Initialise map sized for about `expected` keys; return 0 on allocation failure */
+int hashmap_init(HashMap *m, size_t expected);
+
+/* Release map memory */
+void hashmap_free(HashMap *m);
+
+/* Look up key; return stored value or -1 if missing */
+int hashmap_get(const HashMap *m, uint64_t key);
+
+/* Insert or overwrite key (val must be >= 0); return 0 on allocation failure */
+int hashmap_put(HashMap *m, uint64_t key, int val);
+
+/* 64-bit FNV-1a hash of a NUL-terminated string */
+uint64_t hash_string(const char *s);
+
+/* Same hash over a byte range (not NUL-terminated) */
+uint64_t hash_bytes(const char *s, size_t len);
+
+/* Mix two 64-bit hashes into one key */
+uint64_t hash_combine(uint64_t a, uint64_t b);
+
+#endif /* HASHMAP_H */
@@ -0,0 +1,340 @@
+#include "item_analysis.h"
+#include "logging.h"
+#include "hashmap.h"
+#include "parallel.h"
+#include "data_load.h"
+#include "utils.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define READ_BATCH 8192       /* records per fread */
+#define GROUP_SHARE 0.27      /* upper/lower group size (Kelley) */
+#define PROMPT_WIDTH 40
+
+typedef struct {
+    uint64_t id;
+    long long answers;
+    long long correct;
+} UserTotals;
+
+typedef struct {
+    uint64_t id;
+    long long answers;
+    long long correct;
+    long long option_count[4];
+    long long latency_sum_ms;
+    int key;                  /* 1..4 as seen in correct answers, 0 if never answered right */
+    long long upper_n, upper_correct;
+    long long lower_n, lower_correct;
+} ItemTotals;
+
+/* Growable array of records plus a hash index by id */
+typedef struct {
+    UserTotals *users;
+    int user_count, user_cap;
+    HashMap user_index;
+    ItemTotals *items;
+    int item_count, item_cap;
+    HashMap item_index;
+} Tally;
+
+typedef struct {
+    const char *path;
+    long long first, last;    /* record range [first, last) */
+    int pass;                 /* 1 = totals, 2 = upper/lower groups */
+    Tally tally;              /* pass 1 output */
+    const Tally *merged;      /* pass 2 input */
+    const signed char *group; /* pass 2: +1 upper, -1 lower, 0 middle (by user index) */
+    long long (*group_counts)[4]; /* pass 2 output per item: upper_n, upper_ok, lower_n, lower_ok */
+    int ok;
+} Chunk;
+
+static int tally_init(Tally *t) {
+    memset(t, 0, sizeof(*t));
+    return hashmap_init(&t->user_index, 1024) && hashmap_init(&t->item_index, 1024);
+}
+
+static void tally_free(Tally *t) {
+    free(t->users);
+    free(t->items);
+    hashmap_free(&t->user_index);
+    hashmap_free(&t->item_index);
+}
+
+static UserTotals *tally_user(Tally *t, uint64_t id) {
+    int i = hashmap_get(&t->user_index, id);
+    if (i >= 0) return &t->users[i];
+    if (t->user_count == t->user_cap) {
+        int cap = t->user_cap ? t->user_cap * 2 : 256;
+        UserTotals *grown = realloc(t->users, (size_t)cap * sizeof(*grown));
+        if (!grown) return NULL;
+        t->users = grown;
+        t->user_cap = cap;
+    }
+    i = t->user_count;
+    if (!hashmap_put(&t->user_index, id, i)) return NULL;
+    t->user_count++;
+    memset(&t->users[i], 0, sizeof(t->users[i]));
+    t->users[i].id = id;
+    return &t->users[i];
+}
+
+static ItemTotals *tally_item(Tally *t, uint64_t id) {
+    int i = hashmap_get(&t->item_index, id);
+    if (i >= 0) return &t->items[i];
+    if (t->item_count == t->item_cap) {
+        int cap = t->item_cap ? t->item_cap * 2 : 256;
+        ItemTotals *grown = realloc(t->items, (size_t)cap * sizeof(*grown));
+        if (!grown) return NULL;
+        t->items = grown;
+        t->item_cap = cap;
+    }
+    i = t->item_count;
+    if (!hashmap_put(&t->item_index, id, i)) return NULL;
+    t->item_count++;
+    memset(&t->items[i], 0, sizeof(t->items[i]));
+    t->items[i].id = id;
+    return &t->items[i];
+}
+
+/* Worker: stream this chunk's records and reduce them */
+static void scan_chunk(void *arg) {
+    Chunk *c = (Chunk *)arg;
+    c->ok = 0;
+    if (c->first >= c->last) {
+        c->ok = 1;
+        return;
+    }
+    FILE *fp = fopen(c->path, "rb");
+    if (!fp) return;
+    AnswerEvent *buf = malloc(READ_BATCH * sizeof(*buf));
+    if (!buf || file_seek(fp, c->first * (long long)sizeof(AnswerEvent)) != 0) {
+        free(buf);
+        fclose(fp);
+        return;
+    }
+
+    long long left = c->last - c->first;
+    while (left > 0) {
+        size_t want = left < READ_BATCH ? (size_t)left : READ_BATCH;
+        size_t got = fread(buf, sizeof(*buf), want, fp);
+        if (got == 0) break;
+        left -= (long long)got;
+
+        for (size_t i = 0; i < got; i++) {
+            const AnswerEvent *ev = &buf[i];
+            if (ev->chosen < 1 || ev->chosen > 4) continue; /* damaged record */
+            if (c->pass == 1) {
+                UserTotals *u = tally_user(&c->tally, ev->user_id);
+                ItemTotals *it = tally_item(&c->tally, ev->question_id);
+                if (!u || !it) continue;
+                u->answers++;
+                u->correct += ev->correct;
+                it->answers++;
+                it->correct += ev->correct;
+                it->option_count[ev->chosen - 1]++;
+                it->latency_sum_ms += ev->latency_ms;
+                if (ev->correct) it->key = ev->chosen;
+            } else {
+                int ui = hashmap_get(&c->merged->user_index, ev->user_id);
+                int qi = hashmap_get(&c->merged->item_index, ev->question_id);
+                if (ui < 0 || qi < 0 || c->group[ui] == 0) continue;
+                long long *g = c->group_counts[qi];
+                if (c->group[ui] > 0) {
+                    g[0]++;
+                    g[1] += ev->correct;
+                } else {
+                    g[2]++;
+                    g[3] += ev->correct;
+                }
+            }
+        }
+    }
+    free(buf);
+    fclose(fp);
+    c->ok = 1;
+}
+
+/* Merge one thread's pass-1 tally into the global one */
+static void merge_tally(Tally *dst, const Tally *src) {
+    for (int i = 0; i < src->user_count; i++) {
+        UserTotals *u = tally_user(dst, src->users[i].id);
+        if (!u) continue;
+        u->answers += src->users[i].answers;
+        u->correct += src->users[i].correct;
+    }
+    for (int i = 0; i < src->item_count; i++) {
+        const ItemTotals *s = &src->items[i];
+        ItemTotals *it = tally_item(dst, s->id);
+        if (!it) continue;
+        it->answers += s->answers;
+        it->correct += s->correct;
+        for (int k = 0; k < 4; k++) it->option_count[k] += s->option_count[k];
+        it->latency_sum_ms += s->latency_sum_ms;
+        if (s->key) it->key = s->key;
+    }
+}
+
+/* Sort helpers: users by score, items by difficulty (hardest first) */
+static const UserTotals *g_sort_users;
+
+static int cmp_user_score(const void *a, const void *b) {
+    const UserTotals *ua = &g_sort_users[*(const int *)a];
+    const UserTotals *ub = &g_sort_users[*(const int *)b];
+    /* compare correct/answers without dividing */
+    long long l = ua->correct * ub->answers;
+    long long r = ub->correct * ua->answers;
+    return (l > r) - (l < r);
+}
+
+static int cmp_item_difficulty(const void *a, const void *b) {
+    const ItemTotals *ia = (const ItemTotals *)a;
+    const ItemTotals *ib = (const ItemTotals *)b;
+    double pa = ia->answers ? (double)ia->correct / ia->answers : 0.0;
+    double pb = ib->answers ? (double)ib->correct / ib->answers : 0.0;
+    return (pa > pb) - (pa < pb);
+}
+
+/* Find the prompt text for a question id in the chapter banks */
+static const char *find_prompt(const Question *bank, const uint64_t *ids, int n, uint64_t id) {
+    for (int i = 0; i < n; i++) {
+        if (ids[i] == id) return bank[i].prompt;
+    }
+    return NULL;
+}
+
+/* Run two parallel passes over the log; return 0 if the log can't be read */
+int run_item_analysis(const char *event_path, FILE *out) {
+    long long size = file_size(event_path);
+    if (size < (long long)sizeof(AnswerEvent)) return 0;
+    long long records = size / (long long)sizeof(AnswerEvent);
+
+    int threads = cpu_count();
+    if (records < (long long)threads * READ_BATCH) {
+        threads = (int)(records / READ_BATCH) + 1; /* small log: fewer threads */
+    }
+
+    Chunk *chunks = calloc((size_t)threads, sizeof(*chunks));
+    if (!chunks) return 0;
+    for (int i = 0; i < threads; i++) {
+        chunks[i].path = event_path;
+        chunks[i].first = records * i / threads;
+        chunks[i].last = records * (i + 1) / threads;
+        chunks[i].pass = 1;
+        tally_init(&chunks[i].tally);
+    }
+
+    /* Pass 1: per-user and per-item totals */
+    parallel_run(scan_chunk, chunks, sizeof(*chunks), threads);
+
+    Tally all;
+    tally_init(&all);
+    int ok = 1;
+    for (int i = 0; i < threads; i++) {
+        if (!chunks[i].ok) ok = 0;
+        merge_tally(&all, &chunks[i].tally);
+        tally_free(&chunks[i].tally);
+    }
+
+    /* Split users into upper / lower groups by overall score */
+    signed char *group = calloc((size_t)all.user_count + 1, 1);
+    int *order = malloc(((size_t)all.user_count + 1) * sizeof(*order));
+    long long (*counts)[4] = calloc((size_t)threads * (size_t)(all.item_count + 1), sizeof(*counts));
+    if (!group || !order || !counts) {
+        free(group);
+        free(order);
+        free(counts);
+        tally_free(&all);
+        free(chunks);
+        return 0;
+    }
+    for (int i = 0; i < all.user_count; i++) order[i] = i;
+    g_sort_users = all.users;
+    qsort(order, (size_t)all.user_count, sizeof(*order), cmp_user_score);
+    int group_size = (int)(all.user_count * GROUP_SHARE);
+    if (group_size < 1 && all.user_count >= 2) group_size = 1;
+    for (int i = 0; i < group_size; i++) {
+        group[order[i]] = -1;
+        group[order[all.user_count - 1 - i]] = 1;
+    }
+
+    /* Pass 2: correct answers within each group, per item */
+    for (int i = 0; i < threads; i++) {
+        chunks[i].pass = 2;
+        chunks[i].merged = &all;
+        chunks[i].group = group;
+        chunks[i].group_counts = counts + (size_t)i * (size_t)(all.item_count + 1);
+    }
+    parallel_run(scan_chunk, chunks, sizeof(*chunks), threads);
+    for (int i = 0; i < threads; i++) {
+        if (!chunks[i].ok) ok = 0;
+        for (int q = 0; q < all.item_count; q++) {
+            long long *g = chunks[i].group_counts[q];
+            all.items[q].upper_n += g[0];
+            all.items[q].upper_correct += g[1];
+            all.items[q].lower_n += g[2];
+            all.items[q].lower_correct += g[3];
+        }
+    }
+
+    /* Map question ids back to prompts using the chapter banks */
+    Question *bank = malloc((size_t)CHAPTER_COUNT * MAX_QUESTIONS * sizeof(*bank));
+    uint64_t *bank_ids = malloc((size_t)CHAPTER_COUNT * MAX_QUESTIONS * sizeof(*bank_ids));
+    int bank_count = 0;
+    if (bank && bank_ids) {
+        for (int c = 0; c < CHAPTER_COUNT; c++) {
+            int n = 0;
+            if (CHAPTERS[c].quiz_file[0] != '\0') {
+                n = load_quiz_from_file(CHAPTERS[c].quiz_file, bank + bank_count, MAX_QUESTIONS);
+            }
+            if (n == 0) n = fallback_quiz(&CHAPTERS[c], bank + bank_count, MAX_QUESTIONS);
+            for (int i = 0; i < n; i++) bank_ids[bank_count + i] = question_id(&bank[bank_count + i]);
+            bank_count += n;
+        }
+    }
+
+    qsort(all.items, (size_t)all.item_count, sizeof(*all.items), cmp_item_difficulty);
+
+    fprintf(out, "=== Item Analysis ===\n");
+    fprintf(out, "Answers: %lld | Users: %d | Questions: %d | Threads: %d\n",
+            records, all.user_count, all.item_count, threads);
+    fprintf(out, "p = share correct, D = p(upper 27%%) - p(lower 27%%), * = correct option\n\n");
+    fprintf(out, "%-16s %9s %6s %6s %7s %7s %7s %7s %7s  %s\n",
+            "Question", "Answers", "p", "D", "Opt1", "Opt2", "Opt3", "Opt4", "Avg(s)", "Prompt");
+
+    for (int q = 0; q < all.item_count; q++) {
+        const ItemTotals *it = &all.items[q];
+        double p = it->answers ? (double)it->correct / it->answers : 0.0;
+        double pu = it->upper_n ? (double)it->upper_correct / it->upper_n : 0.0;
+        double pl = it->lower_n ? (double)it->lower_correct / it->lower_n : 0.0;
+        double avg_s = it->answers ? it->latency_sum_ms / 1000.0 / it->answers : 0.0;
+
+        fprintf(out, "%016llx %9lld %6.3f %6.3f", (unsigned long long)it->id, it->answers, p, pu - pl);
+        for (int k = 0; k < 4; k++) {
+            double share = it->answers ? 100.0 * it->option_count[k] / it->answers : 0.0;
+            fprintf(out, " %5.1f%%%c", share, it->key == k + 1 ? '*' : ' ');
+        }
+
+        const char *prompt = NULL;
+        if (bank && bank_ids) prompt = find_prompt(bank, bank_ids, bank_count, it->id);
+        char label[PROMPT_WIDTH + 4];
+        if (prompt) {
+            strncpy(label, prompt, PROMPT_WIDTH);
+            label[PROMPT_WIDTH] = '\0';
+            if (strlen(prompt) > PROMPT_WIDTH) strcat(label, "...");
+        } else {
+            strcpy(label, "(not in current banks)");
+        }
+        fprintf(out, " %7.1f  %s\n", avg_s, label);
+    }
+    if (!ok) fprintf(out, "\nWarning: part of the log could not be read.\n");
+
+    free(bank);
+    free(bank_ids);
+    free(group);
+    free(order);
+    free(counts);
+    tally_free(&all);
+    free(chunks);
+    return 1;
+}
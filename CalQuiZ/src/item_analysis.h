@@ -0,0 +1,16 @@
+#ifndef ITEM_ANALYSIS_H
+#define ITEM_ANALYSIS_H
+
+#include <stdio.h>
+
+/*
+ * Psychometric item analysis over the binary answer log:
+ *  - difficulty (p-value): share of answers that were correct
+ *  - discrimination index: p(upper 27% of users) - p(lower 27%)
+ *  - distractor frequency: share of answers per option
+ * The log is split into record-aligned chunks that are reduced
+ * in parallel on all cores. Returns 0 if the log can't be read.
+ */
+int run_item_analysis(const char *event_path, FILE *out);
+
+#endif /* ITEM_ANALYSIS_H */
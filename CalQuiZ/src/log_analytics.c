@@ -0,0 +1,248 @@
+#include "log_analytics.h"
+#include "data_structs.h"
+#include "hashmap.h"
+#include "parallel.h"
+#include "utils.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define READ_BLOCK (1 << 20)  /* bytes per fread */
+#define MAX_LINE 4096         /* longer lines are skipped */
+#define MAX_NAME 64
+#define MAX_CHAPTERS 64
+
+/* Running totals for one (user, chapter) pair */
+typedef struct {
+    char user[MAX_NAME];
+    char chap[MAX_CHAPTER_LIST];
+    long long tests;
+    long long passes;
+    double pct_sum;
+    double best_pct;
+} UserChapter;
+
+typedef struct {
+    UserChapter *entries;
+    int count;
+    int cap;
+    HashMap index; /* hash(user, chapter) -> entry */
+} Board;
+
+typedef struct {
+    const char *path;
+    long long start, end; /* lines that *start* in [start, end) belong to this chunk */
+    Board board;
+    long long lines;
+    int ok;
+} LogChunk;
+
+static UserChapter *board_entry(Board *b, const char *user, int user_len, const char *chap, int chap_len) {
+    if (user_len >= MAX_NAME) user_len = MAX_NAME - 1;
+    if (chap_len >= MAX_CHAPTER_LIST) chap_len = MAX_CHAPTER_LIST - 1;
+    uint64_t key = hash_combine(hash_bytes(user, (size_t)user_len), hash_bytes(chap, (size_t)chap_len));
+    int i = hashmap_get(&b->index, key);
+    if (i >= 0) return &b->entries[i];
+
+    if (b->count == b->cap) {
+        int cap = b->cap ? b->cap * 2 : 256;
+        UserChapter *grown = realloc(b->entries, (size_t)cap * sizeof(*grown));
+        if (!grown) return NULL;
+        b->entries = grown;
+        b->cap = cap;
+    }
+    i = b->count;
+    if (!hashmap_put(&b->index, key, i)) return NULL;
+    b->count++;
+
+    UserChapter *e = &b->entries[i];
+    memset(e, 0, sizeof(*e));
+    memcpy(e->user, user, (size_t)user_len);
+    memcpy(e->chap, chap, (size_t)chap_len);
+    e->best_pct = -1.0;
+    return e;
+}
+
+static void add_line(Board *b, const TestLine *t) {
+    UserChapter *e = board_entry(b, t->user, t->user_len, t->chap, t->chap_len);
+    if (!e) return;
+    double pct = t->total > 0 ? 100.0 * t->score / t->total : 0.0;
+    e->tests++;
+    e->pct_sum += pct;
+    if (pct >= PASS_PERCENT) e->passes++;
+    if (pct > e->best_pct) e->best_pct = pct;
+}
+
+/* Worker: parse every line that starts inside this chunk */
+static void scan_log_chunk(void *arg) {
+    LogChunk *c = (LogChunk *)arg;
+    c->ok = 0;
+    FILE *fp = fopen(c->path, "rb");
+    if (!fp) return;
+    char *buf = malloc(READ_BLOCK + MAX_LINE);
+    if (!buf) {
+        fclose(fp);
+        return;
+    }
+
+    /* A chunk starting mid-line leaves that line to the previous chunk */
+    long long pos = c->start;
+    int skipping = 0;
+    if (pos > 0) {
+        file_seek(fp, pos - 1);
+        skipping = fgetc(fp) != '\n';
+    } else {
+        file_seek(fp, 0);
+    }
+
+    size_t have = 0;          /* bytes in buf */
+    long long buf_pos = pos;  /* file offset of buf[0] */
+    int done = 0;
+    while (!done) {
+        size_t got = fread(buf + have, 1, READ_BLOCK + MAX_LINE - have, fp);
+        int eof = got == 0;
+        have += got;
+
+        size_t i = 0;
+        while (i < have) {
+            char *nl = memchr(buf + i, '\n', have - i);
+            if (!nl && !eof) break; /* incomplete line: read more */
+            size_t line_end = nl ? (size_t)(nl - buf) : have;
+
+            if (buf_pos + (long long)i >= c->end) {
+                done = 1;
+                break;
+            }
+            if (skipping) {
+                skipping = 0;
+            } else {
+                TestLine t;
+                c->lines++;
+                if (parse_test_line(buf + i, buf + line_end, &t)) add_line(&c->board, &t);
+            }
+            i = line_end + 1;
+        }
+        if (eof) break;
+
+        if (i == 0 && have == READ_BLOCK + MAX_LINE) {
+            /* line longer than the buffer: drop it */
+            skipping = 1;
+            i = have;
+        }
+        memmove(buf, buf + i, have - i);
+        buf_pos += (long long)i;
+        have -= i;
+    }
+
+    free(buf);
+    fclose(fp);
+    c->ok = 1;
+}
+
+/* Sort helper: best average first, then most tests */
+static int cmp_average(const void *a, const void *b) {
+    const UserChapter *x = *(const UserChapter *const *)a;
+    const UserChapter *y = *(const UserChapter *const *)b;
+    double ax = x->pct_sum / x->tests;
+    double ay = y->pct_sum / y->tests;
+    if (ax != ay) return ax < ay ? 1 : -1;
+    return (x->tests < y->tests) - (x->tests > y->tests);
+}
+
+/* Parallel scan of the score log: per chapter averages, pass rates and
+   top_n users by average score. Returns 0 if the log can't be read. */
+int run_leaderboard(const char *log_path, int top_n, FILE *out) {
+    long long size = file_size(log_path);
+    if (size <= 0) return 0;
+
+    int threads = cpu_count();
+    if (size < (long long)threads * READ_BLOCK) {
+        threads = (int)(size / READ_BLOCK) + 1; /* small log: fewer threads */
+    }
+    LogChunk *chunks = calloc((size_t)threads, sizeof(*chunks));
+    if (!chunks) return 0;
+    for (int i = 0; i < threads; i++) {
+        chunks[i].path = log_path;
+        chunks[i].start = size * i / threads;
+        chunks[i].end = size * (i + 1) / threads;
+        hashmap_init(&chunks[i].board.index, 256);
+    }
+
+    parallel_run(scan_log_chunk, chunks, sizeof(*chunks), threads);
+
+    /* Merge the per-thread boards */
+    Board all;
+    memset(&all, 0, sizeof(all));
+    hashmap_init(&all.index, 1024);
+    long long lines = 0;
+    int ok = 1;
+    for (int t = 0; t < threads; t++) {
+        Board *b = &chunks[t].board;
+        if (!chunks[t].ok) ok = 0;
+        lines += chunks[t].lines;
+        for (int i = 0; i < b->count; i++) {
+            const UserChapter *s = &b->entries[i];
+            UserChapter *e = board_entry(&all, s->user, (int)strlen(s->user), s->chap, (int)strlen(s->chap));
+            if (!e) continue;
+            e->tests += s->tests;
+            e->passes += s->passes;
+            e->pct_sum += s->pct_sum;
+            if (s->best_pct > e->best_pct) e->best_pct = s->best_pct;
+        }
+        free(b->entries);
+        hashmap_free(&b->index);
+    }
+    free(chunks);
+
+    /* Group entries by chapter (few chapters, so a linear list is enough) */
+    char chap_codes[MAX_CHAPTERS][MAX_CHAPTER_LIST];
+    int chap_count = 0;
+    for (int i = 0; i < all.count; i++) {
+        int c = 0;
+        while (c < chap_count && strcmp(chap_codes[c], all.entries[i].chap) != 0) c++;
+        if (c == chap_count && chap_count < MAX_CHAPTERS) {
+            strcpy(chap_codes[chap_count++], all.entries[i].chap);
+        }
+    }
+
+    UserChapter **ranked = malloc(((size_t)all.count + 1) * sizeof(*ranked));
+    if (!ranked) {
+        free(all.entries);
+        hashmap_free(&all.index);
+        return 0;
+    }
+
+    fprintf(out, "=== Leaderboard ===\n");
+    fprintf(out, "Log lines: %lld | Threads: %d | Pass mark: %.0f%%\n", lines, threads, PASS_PERCENT);
+
+    for (int c = 0; c < chap_count; c++) {
+        int n = 0;
+        long long tests = 0, passes = 0;
+        double pct_sum = 0.0;
+        for (int i = 0; i < all.count; i++) {
+            UserChapter *e = &all.entries[i];
+            if (strcmp(e->chap, chap_codes[c]) != 0) continue;
+            ranked[n++] = e;
+            tests += e->tests;
+            passes += e->passes;
+            pct_sum += e->pct_sum;
+        }
+        qsort(ranked, (size_t)n, sizeof(*ranked), cmp_average);
+
+        fprintf(out, "\nChapter %s: %lld tests by %d users | Average: %.1f%% | Pass rate: %.1f%%\n",
+                chap_codes[c], tests, n, pct_sum / tests, 100.0 * passes / tests);
+        fprintf(out, "  %-4s %-24s %7s %8s %8s %9s\n", "Rank", "User", "Tests", "Average", "Best", "Pass rate");
+        for (int i = 0; i < n && i < top_n; i++) {
+            const UserChapter *e = ranked[i];
+            fprintf(out, "  %-4d %-24s %7lld %7.1f%% %7.1f%% %8.1f%%\n",
+                    i + 1, e->user, e->tests, e->pct_sum / e->tests, e->best_pct,
+                    100.0 * e->passes / e->tests);
+        }
+    }
+    if (chap_count == 0) fprintf(out, "\nNo test results found.\n");
+    if (!ok) fprintf(out, "\nWarning: part of the log could not be read.\n");
+
+    free(ranked);
+    free(all.entries);
+    hashmap_free(&all.index);
+    return 1;
+}
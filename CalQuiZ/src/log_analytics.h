@@ -0,0 +1,14 @@
+#ifndef LOG_ANALYTICS_H
+#define LOG_ANALYTICS_H
+
+#include <stdio.h>
+#include "logging.h"
+
+/* A test result is a pass at or above this percentage */
+#define PASS_PERCENT 60.0
+
+/* Parallel scan of the score log: per chapter averages, pass rates and
+   top_n users by average score. Returns 0 if the log can't be read. */
+int run_leaderboard(const char *log_path, int top_n, FILE *out);
+
+#endif /* LOG_ANALYTICS_H */
@@ -1,33 +1,94 @@
 #include "logging.h"
+#include "score_index.h"
 #include <stdio.h>
 #include <time.h>
 #include <string.h>
+#include "utils.h"
 
-#ifdef _WIN32
-#include <direct.h>
-#include <io.h>
-#define mkdir(path, mode) _mkdir(path)
-#define access(path, mode) _access(path, mode)
-#else
-#include <sys/stat.h>
-#include <unistd.h>
-#endif
-
-#define LOG_FILE "logs/quiz_score.log"
-#define LOG_DIR "logs"
-
-/* Ensure logs directory exists */
-static void ensure_log_dir(void) {
-#ifdef _WIN32
-    if (_access(LOG_DIR, 0) != 0) {
-        _mkdir(LOG_DIR);
+/* Create logs directory if it doesn't exist */
+void ensure_log_dir(void) {
+    ensure_dir(LOG_DIR);
+}
+
+/* Write one [TEST] line; shared by single and batch logging */
+static void write_test_line(FILE *fp, const char *timestamp, const char *username,
+                            const char *chap_code, int score, int total) {
+    double percentage;
+
+if (total > 0) {
+    percentage = (double)score / total * 100.0;
+} else {
+    percentage = 0.0;
+}
+    
+    /* Log format: [TIMESTAMP] [LEVEL] User: username | Chapter: code | Score: X/Y (Z%) */
+    fprintf(fp, "[%s] [TEST] User: %s | Chapter: %s | Score: %d/%d (%.1f%%)\n", 
+            timestamp, username, chap_code, score, total, percentage);
+}
+
+/* Advance p past the literal lit; NULL if the text doesn't match */
+static const char *expect(const char *p, const char *end, const char *lit) {
+    while (*lit) {
+        if (p >= end || *p != *lit) return NULL;
+        p++;
+        lit++;
     }
-#else
-    struct stat st = {0};
-    if (stat(LOG_DIR, &st) == -1) {
-        mkdir(LOG_DIR, 0700);
+    return p;
+}
+
+/* Field text runs up to the next " | <label>: "; return pointer after the label */
+static const char *read_field(const char *p, const char *end, const char *label, int *len) {
+    const char *start = p;
+    while (p < end) {
+        const char *bar = memchr(p, '|', (size_t)(end - p));
+        if (!bar) return NULL;
+        if (bar > start && bar[-1] == ' ') {
+            const char *after = expect(bar + 1, end, label);
+            if (after) {
+                *len = (int)(bar - 1 - start);
+                return after;
+            }
+        }
+        p = bar + 1;
     }
-#endif
+    return NULL;
+}
+
+/* Parse an unsigned decimal number */
+static const char *read_int(const char *p, const char *end, int *value) {
+    if (p >= end || *p < '0' || *p > '9') return NULL;
+    int v = 0;
+    while (p < end && *p >= '0' && *p <= '9') {
+        if (v < 100000000) v = v * 10 + (*p - '0');
+        p++;
+    }
+    *value = v;
+    return p;
+}
+
+/* Parse one log line [line, end) without sscanf/strstr; return 1 if it is a TEST line */
+int parse_test_line(const char *line, const char *end, TestLine *out) {
+    /* [YYYY-MM-DD HH:MM:SS] [TEST] User: name | Chapter: code | Score: X/Y (Z%) */
+    const char *p = expect(line, end, "[");
+    if (!p) return 0;
+    p = memchr(p, ']', (size_t)(end - p));
+    if (!p) return 0;
+    p = expect(p + 1, end, " [TEST] User: ");
+    if (!p) return 0;
+
+    out->user = p;
+    p = read_field(p, end, " Chapter: ", &out->user_len);
+    if (!p) return 0;
+    out->chap = p;
+    p = read_field(p, end, " Score: ", &out->chap_len);
+    if (!p) return 0;
+
+    p = read_int(p, end, &out->score);
+    if (!p) return 0;
+    p = expect(p, end, "/");
+    if (!p) return 0;
+    p = read_int(p, end, &out->total);
+    return p != NULL;
 }
 
 /* Log test results to file */
@@ -41,18 +102,53 @@ void log_test_result(const char *username, const char *chap_code, int score, int
     char timestamp[64];
     strftime(timestamp, sizeof(timestamp), "%Y-%m-%d %H:%M:%S", lt);
     
-    double percentage;
+    write_test_line(fp, timestamp, username, chap_code, score, total);
+    fclose(fp);
 
-if (total > 0) {
-    percentage = (double)score / total * 100.0;
-} else {
-    percentage = 0.0;
+    /* Keep the per-chapter score distribution in step with the log */
+    score_index_add(chap_code, score, total);
 }
-    
-    /* Log format: [TIMESTAMP] [LEVEL] User: username | Chapter: code | Score: X/Y (Z%) */
-    fprintf(fp, "[%s] [TEST] User: %s | Chapter: %s | Score: %d/%d (%.1f%%)\n", 
-            timestamp, username, chap_code, score, total, percentage);
-    
+
+/* Log many test results at once (bulk grading): one open of the log
+   and of the score index instead of one per result */
+void log_test_results(const TestResult *results, int n) {
+    if (n <= 0) return;
+    ensure_log_dir();
+    FILE *fp = fopen(LOG_FILE, "a");
+    if (!fp) return;
+
+    time_t now = time(NULL);
+    struct tm *lt = localtime(&now);
+    char timestamp[64];
+    strftime(timestamp, sizeof(timestamp), "%Y-%m-%d %H:%M:%S", lt);
+
+    for (int i = 0; i < n; i++) {
+        write_test_line(fp, timestamp, results[i].username, results[i].chap_code,
+                        results[i].score, results[i].total);
+    }
+    fclose(fp);
+
+    score_index_add_batch(results, n);
+}
+
+/* Append one answer record to the binary event log */
+void log_answer_event(uint64_t user_id, uint64_t question_id, int chosen, int correct, long long latency_ms) {
+    ensure_log_dir();
+    FILE *fp = fopen(ANSWER_LOG_FILE, "ab");
+    if (!fp) return;
+
+    AnswerEvent ev;
+    memset(&ev, 0, sizeof(ev));
+    ev.user_id = user_id;
+    ev.question_id = question_id;
+    ev.timestamp = (int64_t)time(NULL);
+    if (latency_ms < 0) latency_ms = 0;
+    if (latency_ms > UINT32_MAX) latency_ms = UINT32_MAX;
+    ev.latency_ms = (uint32_t)latency_ms;
+    ev.chosen = (uint8_t)chosen;
+    ev.correct = correct ? 1 : 0;
+
+    fwrite(&ev, sizeof(ev), 1, fp);
     fclose(fp);
 }
 
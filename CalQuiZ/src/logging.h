@@ -1,9 +1,58 @@
 #ifndef LOGGING_H
 #define LOGGING_H
 
+#include <stdint.h>
+
+#define LOG_FILE "logs/quiz_score.log"
+#define LOG_DIR "logs"
+#define ANSWER_LOG_FILE "logs/answers.bin"
+
+/* One test result, for batch logging */
+typedef struct {
+    char username[64];
+    char chap_code[64];
+    int score;
+    int total;
+} TestResult;
+
+/* One fixed-size (32-byte) record per answer in the binary event log */
+typedef struct {
+    uint64_t user_id;     /* hash_string(username) */
+    uint64_t question_id; /* question_id(&q) */
+    int64_t timestamp;    /* seconds since epoch */
+    uint32_t latency_ms;  /* time from showing the question to the answer */
+    uint8_t chosen;       /* option picked, 1..4 */
+    uint8_t correct;      /* 1 if chosen is the right option */
+    uint16_t reserved;    /* keeps the record 8-byte aligned; always 0 */
+} AnswerEvent;
+
+/* Fields of one "[TEST] User: ... | Chapter: ... | Score: X/Y" line.
+   user and chap point into the parsed line (not NUL-terminated). */
+typedef struct {
+    const char *user;
+    int user_len;
+    const char *chap;
+    int chap_len;
+    int score;
+    int total;
+} TestLine;
+
+/* Parse one log line [line, end) without sscanf/strstr; return 1 if it is a TEST line */
+int parse_test_line(const char *line, const char *end, TestLine *out);
+
+/* Create logs directory if it doesn't exist */
+void ensure_log_dir(void);
+
 /* Log test results to file */
 void log_test_result(const char *username, const char *chap_code, int score, int total);
 
+/* Log many test results at once (bulk grading): one open of the log
+   and of the score index instead of one per result */
+void log_test_results(const TestResult *results, int n);
+
+/* Append one answer record to the binary event log */
+void log_answer_event(uint64_t user_id, uint64_t question_id, int chosen, int correct, long long latency_ms);
+
 /* Log general events (like program start, mode selection, etc.) */
 void log_event(const char *level, const char *message);
 
@@ -9,6 +9,11 @@
  *  - Run Learn and Test modes for selected chapters
  *    by calling the quiz runner functions in quiz_engine.c.
  *  - Show score history.
+ *  - Run batch commands given on the command line
+ *    (e.g. "CalQuiZ items" for item analysis,
+ *    "CalQuiZ leaderboard" for score log reports,
+ *    "CalQuiZ papers" for printed exam papers,
+ *    "CalQuiZ grade" for offline answer sheets).
  *  - Use other modules for:
  *      - data (data_load / data_structs),
  *      - utilities (utils),
@@ -23,6 +28,10 @@
 #include "utils.h"
 #include "quiz_engine.h"
 #include "logging.h"
+#include "item_analysis.h"
+#include "log_analytics.h"
+#include "paper_gen.h"
+#include "grading.h"
 
 /* Display score history from log file */
 static void show_score_history(void) {
@@ -128,7 +137,7 @@ static void run_chapter_menu(const Chapter *chap, const char *username, int mode
     log_event("INFO", log_msg);
     
     if (mode == 0) {
-        run_learn_mode(chap);
+        run_learn_mode(chap, username);
     } else {
         run_test_mode(chap, username);
     }
@@ -194,7 +203,70 @@ static void main_menu(const char *username) {
     }
 }
 
-int main(void) {
+/* Batch commands (no interactive menu); return exit code */
+static int run_command(int argc, char *argv[]) {
+    if (strcmp(argv[1], "items") == 0) {
+        const char *path = ANSWER_LOG_FILE;
+        if (argc > 2) path = argv[2];
+        if (!run_item_analysis(path, stdout)) {
+            fprintf(stderr, "No answer events found in %s\n", path);
+            return 1;
+        }
+        return 0;
+    }
+
+    if (strcmp(argv[1], "leaderboard") == 0) {
+        int top_n = 10;
+        const char *path = LOG_FILE;
+        if (argc > 2) top_n = atoi(argv[2]);
+        if (argc > 3) path = argv[3];
+        if (top_n < 1) top_n = 10;
+        if (!run_leaderboard(path, top_n, stdout)) {
+            fprintf(stderr, "Could not read %s\n", path);
+            return 1;
+        }
+        return 0;
+    }
+
+    if (strcmp(argv[1], "papers") == 0) {
+        if (argc < 6) {
+            fprintf(stderr, "Usage: %s papers <chapters> <questions> <versions> <seed> [overlap_percent] [out_dir]\n", argv[0]);
+            fprintf(stderr, "Example: %s papers LIM,DER 20 500 42 50 papers\n", argv[0]);
+            return 2;
+        }
+        PaperJob job;
+        job.chapters = argv[2];
+        job.questions = atoi(argv[3]);
+        job.versions = atoi(argv[4]);
+        job.seed = strtoull(argv[5], NULL, 10);
+        job.overlap_percent = argc > 6 ? atoi(argv[6]) : 0;
+        job.out_dir = argc > 7 ? argv[7] : "papers";
+        if (job.questions < 1 || job.versions < 1) {
+            fprintf(stderr, "Questions and versions must be at least 1\n");
+            return 2;
+        }
+        return generate_papers(&job, stdout) == job.versions ? 0 : 1;
+    }
+
+    if (strcmp(argv[1], "grade") == 0) {
+        if (argc < 4) {
+            fprintf(stderr, "Usage: %s grade <key_dir> <sheet_file>...\n", argv[0]);
+            fprintf(stderr, "Sheet lines: username,paper_number,answers (e.g. alice,7,3142-21)\n");
+            return 2;
+        }
+        return grade_sheets(argv[2], argv + 3, argc - 3, stdout) > 0 ? 0 : 1;
+    }
+
+    fprintf(stderr, "Unknown command: %s\n", argv[1]);
+    fprintf(stderr, "Usage: %s [items [answer_log] | leaderboard [top_n [score_log]] | papers ... | grade ...]\n", argv[0]);
+    return 2;
+}
+
+int main(int argc, char *argv[]) {
+    if (argc > 1) {
+        return run_command(argc, argv);
+    }
+
     srand((unsigned)time(NULL));
     setup_console_utf8();
     clear_screen();
@@ -0,0 +1,210 @@
+#include "paper_gen.h"
+#include "data_load.h"
+#include "exam_builder.h"
+#include "parallel.h"
+#include "utils.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define MAX_PATH_LEN 512
+
+/* Shared, read-only input for all workers */
+typedef struct {
+    const PaperJob *job;
+    const Question *bank;
+    int bank_count;
+    const ExamIndex *ix;   /* built once for the whole bank */
+    const int *core;       /* questions every version contains */
+    int core_count;
+    uint64_t core_topics;
+} PaperShared;
+
+typedef struct {
+    const PaperShared *shared;
+    int first_version;     /* this worker does first, first+step, ... */
+    int step;
+    int written;
+} PaperWorker;
+
+/* Load every chapter named in a comma-separated list; return bank size.
+   codes must be canonical (trimmed, no duplicates), see canonical_chapters.
+   The codes that were found are written to loaded, in the same form. */
+static int load_bank(const char *codes, char *loaded, Question *bank, int max_out, FILE *msg) {
+    int count = 0;
+    loaded[0] = '\0';
+    const char *p = codes;
+    while (*p) {
+        char code[8] = {0};
+        int len = 0;
+        while (*p && *p != ',') {
+            if (len < 7) code[len++] = *p;
+            p++;
+        }
+        if (*p == ',') p++;
+        if (len == 0) continue;
+
+        const Chapter *chap = NULL;
+        for (int i = 0; i < CHAPTER_COUNT; i++) {
+            if (strcmp(CHAPTERS[i].code, code) == 0) chap = &CHAPTERS[i];
+        }
+        if (!chap) {
+            fprintf(msg, "Unknown chapter code: %s\n", code);
+            continue;
+        }
+        int room = max_out - count;
+        if (room > MAX_QUESTIONS) room = MAX_QUESTIONS; /* same per-chapter limit as Test Mode */
+        int n = 0;
+        if (chap->quiz_file[0] != '\0') {
+            n = load_quiz_from_file(chap->quiz_file, bank + count, room);
+        }
+        if (n == 0) n = fallback_quiz(chap, bank + count, room);
+        count += n;
+        if (loaded[0] != '\0') strcat(loaded, ",");
+        strcat(loaded, chap->code);
+    }
+    return count;
+}
+
+static int write_version(const PaperShared *sh, int version, Question *paper, int *picked,
+                         unsigned char *used) {
+    const PaperJob *job = sh->job;
+    Rng rng;
+    rng_seed(&rng, job->seed, (uint64_t)version + 1); /* stream 0 chose the core */
+
+    /* Per-version part: topic/difficulty-balanced pick outside the core */
+    int want = job->questions - sh->core_count;
+    int count = 0;
+    memset(used, 0, (size_t)sh->bank_count);
+    for (int i = 0; i < sh->core_count; i++) {
+        picked[count++] = sh->core[i];
+        used[sh->core[i]] = 1;
+    }
+    if (want > 0) {
+        /* Topics the core missed; 0 when it covers them all */
+        ExamSpec spec = {sh->ix->all_topics & ~sh->core_topics, 0.0};
+        count += exam_pick(sh->ix, want, &spec, NULL, &rng, used, picked + count);
+    }
+
+    /* Question order and option order differ per version */
+    shuffle_indices_rng(picked, count, &rng);
+    for (int i = 0; i < count; i++) {
+        paper[i] = sh->bank[picked[i]];
+        shuffle_options(&paper[i], &rng);
+    }
+
+    char path[MAX_PATH_LEN];
+    snprintf(path, sizeof(path), "%s/paper_%03d.txt", job->out_dir, version + 1);
+    FILE *fp = fopen(path, "w");
+    if (!fp) return 0;
+    fprintf(fp, "CalQuiZ Exam Paper %03d\n", version + 1);
+    fprintf(fp, "Chapters: %s\n", job->chapters);
+    fprintf(fp, "Questions: %d\n\n", count);
+    for (int i = 0; i < count; i++) {
+        fprintf(fp, "%d) %s\n", i + 1, paper[i].prompt);
+        for (int k = 0; k < 4; k++) fprintf(fp, "   %d) %s\n", k + 1, paper[i].options[k]);
+        fprintf(fp, "\n");
+    }
+    fclose(fp);
+
+    /* Key: "Answers:" line is what the grader reads */
+    snprintf(path, sizeof(path), "%s/key_%03d.txt", job->out_dir, version + 1);
+    fp = fopen(path, "w");
+    if (!fp) return 0;
+    fprintf(fp, "Answer key - Paper %03d\n", version + 1);
+    fprintf(fp, "Chapters: %s\n", job->chapters);
+    fprintf(fp, "Answers: ");
+    for (int i = 0; i < count; i++) fputc('1' + paper[i].correctIndex, fp);
+    fprintf(fp, "\n\n");
+    for (int i = 0; i < count; i++) fprintf(fp, "%d) %d\n", i + 1, paper[i].correctIndex + 1);
+    fclose(fp);
+    return 1;
+}
+
+/* Worker: write every step-th version */
+static void paper_worker(void *arg) {
+    PaperWorker *w = (PaperWorker *)arg;
+    const PaperShared *sh = w->shared;
+    Question *paper = malloc((size_t)sh->job->questions * sizeof(*paper));
+    int *picked = malloc((size_t)sh->job->questions * sizeof(*picked));
+    unsigned char *used = malloc((size_t)sh->bank_count);
+    w->written = 0;
+    if (paper && picked && used) {
+        for (int v = w->first_version; v < sh->job->versions; v += w->step) {
+            w->written += write_version(sh, v, paper, picked, used);
+        }
+    }
+    free(paper);
+    free(picked);
+    free(used);
+}
+
+/* Generate all versions in parallel (one random stream per version).
+   Progress and errors go to msg. Returns number of papers written. */
+int generate_papers(const PaperJob *job, FILE *msg) {
+    int max_bank = CHAPTER_COUNT * MAX_QUESTIONS;
+    Question *bank = malloc((size_t)max_bank * sizeof(*bank));
+    if (!bank) return 0;
+    /* "LIM, DER,LIM" loads each chapter once and is written as "DER,LIM" */
+    char requested[MAX_CHAPTER_LIST], chapters[MAX_CHAPTER_LIST];
+    canonical_chapters(job->chapters, requested, (int)sizeof(requested));
+    int n = load_bank(requested, chapters, bank, max_bank, msg);
+    if (n == 0) {
+        fprintf(msg, "No questions found for chapters: %s\n", job->chapters);
+        free(bank);
+        return 0;
+    }
+
+    PaperJob fixed = *job;
+    fixed.chapters = chapters;
+    if (fixed.questions > n) {
+        fprintf(msg, "Only %d questions available. Using %d per paper.\n", n, n);
+        fixed.questions = n;
+    }
+    if (fixed.overlap_percent < 0) fixed.overlap_percent = 0;
+    if (fixed.overlap_percent > 100) fixed.overlap_percent = 100;
+
+    ExamIndex ix;
+    int *core = malloc((size_t)(fixed.questions + 1) * sizeof(*core));
+    unsigned char *used = calloc((size_t)n, 1);
+    if (!core || !used || !exam_index_build(&ix, bank, n)) {
+        free(core);
+        free(used);
+        free(bank);
+        return 0;
+    }
+
+    /* Stream 0 picks the shared core with a balanced pick */
+    Rng rng;
+    rng_seed(&rng, fixed.seed, 0);
+    int core_count = (fixed.questions * fixed.overlap_percent + 50) / 100;
+    core_count = exam_pick(&ix, core_count, NULL, NULL, &rng, used, core);
+    uint64_t core_topics = 0;
+    for (int i = 0; i < core_count; i++) core_topics |= bank[core[i]].topics;
+    free(used);
+
+    ensure_dir(fixed.out_dir);
+
+    PaperShared shared = {&fixed, bank, n, &ix, core, core_count, core_topics};
+    int threads = cpu_count();
+    if (threads > fixed.versions) threads = fixed.versions;
+    if (threads < 1) threads = 1;
+    PaperWorker *workers = calloc((size_t)threads, sizeof(*workers));
+    int written = 0;
+    if (workers) {
+        for (int i = 0; i < threads; i++) {
+            workers[i].shared = &shared;
+            workers[i].first_version = i;
+            workers[i].step = threads;
+        }
+        parallel_run(paper_worker, workers, sizeof(*workers), threads);
+        for (int i = 0; i < threads; i++) written += workers[i].written;
+        free(workers);
+    }
+
+    fprintf(msg, "Wrote %d paper(s) with %d questions each (%d shared) to %s/ using %d thread(s)\n",
+            written, fixed.questions, core_count, fixed.out_dir, threads);
+    exam_index_free(&ix);
+    free(core);
+    free(bank);
+    return written;
+}
@@ -0,0 +1,21 @@
+#ifndef PAPER_GEN_H
+#define PAPER_GEN_H
+
+#include <stdint.h>
+#include <stdio.h>
+
+/* One batch of exam papers */
+typedef struct {
+    const char *chapters;  /* comma-separated chapter codes, e.g. "LIM,DER" */
+    int questions;         /* questions per paper */
+    int versions;          /* number of distinct papers */
+    uint64_t seed;         /* same seed -> same papers */
+    int overlap_percent;   /* share of questions every version has in common */
+    const char *out_dir;   /* gets paper_NNN.txt and key_NNN.txt */
+} PaperJob;
+
+/* Generate all versions in parallel (one random stream per version).
+   Progress and errors go to msg. Returns number of papers written. */
+int generate_papers(const PaperJob *job, FILE *msg);
+
+#endif /* PAPER_GEN_H */
@@ -0,0 +1,85 @@
+#ifndef _WIN32
+#define _POSIX_C_SOURCE 200809L
+#endif
+
+#include "parallel.h"
+#include <stdlib.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <pthread.h>
+#include <unistd.h>
+#endif
+
+#define MAX_THREADS 256
+
+typedef struct {
+    void (*fn)(void *);
+    void *arg;
+} ThreadStart;
+
+#ifdef _WIN32
+static DWORD WINAPI thread_main(LPVOID p) {
+    ThreadStart *s = (ThreadStart *)p;
+    s->fn(s->arg);
+    return 0;
+}
+#else
+static void *thread_main(void *p) {
+    ThreadStart *s = (ThreadStart *)p;
+    s->fn(s->arg);
+    return NULL;
+}
+#endif
+
+/* Number of online CPU cores (at least 1) */
+int cpu_count(void) {
+#ifdef _WIN32
+    SYSTEM_INFO si;
+    GetSystemInfo(&si);
+    int n = (int)si.dwNumberOfProcessors;
+#else
+    int n = (int)sysconf(_SC_NPROCESSORS_ONLN);
+#endif
+    if (n < 1) n = 1;
+    if (n > MAX_THREADS) n = MAX_THREADS;
+    return n;
+}
+
+/* Run fn on n threads and wait for all of them.
+   Thread i gets (char *)args + i * arg_size as its argument. */
+void parallel_run(void (*fn)(void *), void *args, size_t arg_size, int n) {
+    if (n > MAX_THREADS) n = MAX_THREADS;
+    ThreadStart starts[MAX_THREADS];
+#ifdef _WIN32
+    HANDLE threads[MAX_THREADS];
+#else
+    pthread_t threads[MAX_THREADS];
+#endif
+    int started[MAX_THREADS];
+
+    /* Thread 0 runs on the calling thread, the others get their own */
+    for (int i = 1; i < n; i++) {
+        starts[i].fn = fn;
+        starts[i].arg = (char *)args + (size_t)i * arg_size;
+#ifdef _WIN32
+        threads[i] = CreateThread(NULL, 0, thread_main, &starts[i], 0, NULL);
+        started[i] = threads[i] != NULL;
+#else
+        started[i] = pthread_create(&threads[i], NULL, thread_main, &starts[i]) == 0;
+#endif
+        if (!started[i]) fn(starts[i].arg); /* could not start: do the work inline */
+    }
+    if (n > 0) fn(args);
+
+    for (int i = 1; i < n; i++) {
+        if (!started[i]) continue;
+#ifdef _WIN32
+        WaitForSingleObject(threads[i], INFINITE);
+        CloseHandle(threads[i]);
+#else
+        pthread_join(threads[i], NULL);
+#endif
+    }
+}
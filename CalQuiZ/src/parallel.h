@@ -0,0 +1,13 @@
+#ifndef PARALLEL_H
+#define PARALLEL_H
+
+#include <stddef.h>
+
+/* Number of online CPU cores (at least 1) */
+int cpu_count(void);
+
+/* Run fn on n threads and wait for all of them.
+   Thread i gets (char *)args + i * arg_size as its argument. */
+void parallel_run(void (*fn)(void *), void *args, size_t arg_size, int n);
+
+#endif /* PARALLEL_H */
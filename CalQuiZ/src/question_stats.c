@@ -0,0 +1,109 @@
+#include "question_stats.h"
+#include "logging.h"
+#include <stdlib.h>
+
+/* Review interval doubles with each consecutive correct answer (Leitner boxes) */
+#define BASE_INTERVAL_SEC (24L * 60 * 60)
+#define MAX_STREAK_SHIFT 6
+
+static int reserve(StatsStore *st, int need) {
+    if (need <= st->cap) return 1;
+    int cap = st->cap ? st->cap : 64;
+    while (cap < need) cap *= 2;
+    StatRecord *grown = realloc(st->recs, (size_t)cap * sizeof(*grown));
+    if (!grown) return 0;
+    st->recs = grown;
+    st->cap = cap;
+    return 1;
+}
+
+/* Load all records from path (created if missing); return 0 on failure */
+int stats_open(StatsStore *st, const char *path) {
+    st->recs = NULL;
+    st->count = 0;
+    st->cap = 0;
+    st->fp = NULL;
+    if (!hashmap_init(&st->index, 64)) return 0;
+
+    ensure_log_dir();
+    st->fp = fopen(path, "r+b");
+    if (!st->fp) st->fp = fopen(path, "w+b");
+    if (!st->fp) return 1; /* still usable, just not persisted */
+
+    StatRecord r;
+    while (fread(&r, sizeof(r), 1, st->fp) == 1) {
+        if (!reserve(st, st->count + 1)) break;
+        st->recs[st->count] = r;
+        hashmap_put(&st->index, hash_combine(r.user_id, r.question_id), st->count);
+        st->count++;
+    }
+    return 1;
+}
+
+/* Close file and release memory */
+void stats_close(StatsStore *st) {
+    if (st->fp) fclose(st->fp);
+    st->fp = NULL;
+    free(st->recs);
+    st->recs = NULL;
+    st->count = 0;
+    st->cap = 0;
+    hashmap_free(&st->index);
+}
+
+/* Find record for (user, question); NULL if never attempted */
+const StatRecord *stats_find(const StatsStore *st, uint64_t user_id, uint64_t question_id) {
+    int i = hashmap_get(&st->index, hash_combine(user_id, question_id));
+    if (i < 0) return NULL;
+    return &st->recs[i];
+}
+
+/* Update one record after an answer and write just that record back to disk */
+void stats_record_answer(StatsStore *st, uint64_t user_id, uint64_t question_id, int correct) {
+    uint64_t key = hash_combine(user_id, question_id);
+    int i = hashmap_get(&st->index, key);
+    if (i < 0) {
+        if (!reserve(st, st->count + 1)) return;
+        i = st->count;
+        StatRecord fresh = {user_id, question_id, 0, 0, 0, 0};
+        st->recs[i] = fresh;
+        if (!hashmap_put(&st->index, key, i)) return;
+        st->count++;
+    }
+
+    StatRecord *r = &st->recs[i];
+    r->attempts++;
+    if (correct) {
+        r->correct++;
+        r->streak++;
+    } else {
+        r->streak = 0;
+    }
+    r->last_seen = (uint32_t)time(NULL);
+
+    if (st->fp) {
+        fseek(st->fp, (long)i * (long)sizeof(StatRecord), SEEK_SET);
+        fwrite(r, sizeof(*r), 1, st->fp);
+        fflush(st->fp);
+    }
+}
+
+/* Selection weight for spaced repetition: high for missed or overdue items,
+   low for items answered correctly recently. r may be NULL (never seen). */
+double stats_weight(const StatRecord *r, time_t now) {
+    if (!r || r->attempts == 0) {
+        return 2.2; /* same as a 50% error rate item that is due */
+    }
+
+    /* Error rate with +1/+2 smoothing so one lucky answer does not zero it */
+    double err = (double)(r->attempts - r->correct + 1) / (double)(r->attempts + 2);
+
+    /* How far through its review interval the item is (capped at 1 = due) */
+    int shift = r->streak < MAX_STREAK_SHIFT ? (int)r->streak : MAX_STREAK_SHIFT;
+    double interval = (double)(BASE_INTERVAL_SEC << shift);
+    double elapsed = difftime(now, (time_t)r->last_seen);
+    double due = elapsed <= 0.0 ? 0.0 : elapsed / interval;
+    if (due > 1.0) due = 1.0;
+
+    return 0.2 + 2.0 * err + due;
+}
@@ -0,0 +1,45 @@
+#ifndef QUESTION_STATS_H
+#define QUESTION_STATS_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include <time.h>
+#include "hashmap.h"
+
+#define STATS_FILE "logs/question_stats.dat"
+
+/* One fixed-size record per (user, question) pair, stored as-is on disk */
+typedef struct {
+    uint64_t user_id;     /* hash_string(username) */
+    uint64_t question_id; /* question_id(&q) */
+    uint32_t attempts;
+    uint32_t correct;
+    uint32_t streak;      /* consecutive correct answers */
+    uint32_t last_seen;   /* time of last attempt (seconds since epoch) */
+} StatRecord;
+
+typedef struct {
+    StatRecord *recs; /* record i lives at file offset i * sizeof(StatRecord) */
+    int count;
+    int cap;
+    HashMap index;    /* hash_combine(user, question) -> record position */
+    FILE *fp;         /* NULL if the file could not be opened (stats kept in memory only) */
+} StatsStore;
+
+/* Load all records from path (created if missing); return 0 on failure */
+int stats_open(StatsStore *st, const char *path);
+
+/* Close file and release memory */
+void stats_close(StatsStore *st);
+
+/* Find record for (user, question); NULL if never attempted */
+const StatRecord *stats_find(const StatsStore *st, uint64_t user_id, uint64_t question_id);
+
+/* Update one record after an answer and write just that record back to disk */
+void stats_record_answer(StatsStore *st, uint64_t user_id, uint64_t question_id, int correct);
+
+/* Selection weight for spaced repetition: high for missed or overdue items,
+   low for items answered correctly recently. r may be NULL (never seen). */
+double stats_weight(const StatRecord *r, time_t now);
+
+#endif /* QUESTION_STATS_H */
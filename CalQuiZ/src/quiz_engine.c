@@ -2,9 +2,14 @@
 #include "data_load.h"
 #include "utils.h"
 #include "logging.h"
+#include "question_stats.h"
+#include "sampler.h"
+#include "score_index.h"
+#include "exam_builder.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <time.h>
 
 /* 
  * quiz_engine.c
@@ -16,8 +21,42 @@
  * score history. Those higher-level flows are handled by main.c.
  */
 
+/* Order questions so that early ones favour this user's weak or
+   overdue items (spaced repetition). Unseen questions get a neutral weight. */
+static void order_questions(const StatsStore *stats, uint64_t user_id,
+                            const Question *all, int total_loaded, int *idx) {
+    double weights[MAX_QUESTIONS];
+    time_t now = time(NULL);
+    for (int i = 0; i < total_loaded; i++) {
+        const StatRecord *r = stats_find(stats, user_id, question_id(&all[i]));
+        weights[i] = stats_weight(r, now);
+    }
+    weighted_order(idx, weights, total_loaded);
+}
+
+/* Pick ask_total questions covering the bank's topic tags with a
+   representative difficulty; order gives the adaptive preference.
+   Falls back to the plain order if the index could not be built. */
+static int select_exam(const ExamIndex *ix, const int *order, int total_loaded, int ask_total, int *idx) {
+    int rank[MAX_QUESTIONS];
+    unsigned char used[MAX_QUESTIONS] = {0};
+    int picked = 0;
+    if (ix->members) {
+        for (int i = 0; i < total_loaded; i++) rank[order[i]] = i;
+        Rng rng;
+        rng_seed(&rng, ((uint64_t)rand() << 32) ^ (uint64_t)time(NULL), 0);
+        ExamSpec spec = {ix->all_topics, 0.0}; /* all topics, bank-average difficulty */
+        picked = exam_pick(ix, ask_total, &spec, rank, &rng, used, idx);
+    }
+    for (int i = 0; i < total_loaded && picked < ask_total; i++) {
+        if (!used[order[i]]) idx[picked++] = order[i];
+    }
+    shuffle_indices(idx, picked); /* don't present topics in pick order */
+    return picked;
+}
+
 /* Learn mode: Show immediate feedback with explanations (no score recording) */
-void run_learn_mode(const Chapter *chap) {
+void run_learn_mode(const Chapter *chap, const char *username) {
     clear_screen();
     printf("=== Learn Mode: %s ===\n\n", chap->name);
     printf("Type 'q' to quit and return to menu at any time\n\n");
@@ -50,9 +89,12 @@ void run_learn_mode(const Chapter *chap) {
         }
     }
 
+    StatsStore stats;
+    stats_open(&stats, STATS_FILE);
+    uint64_t user_id = hash_string(username);
+
     int idx[MAX_QUESTIONS];
-    for (int i = 0; i < total_loaded; i++) idx[i] = i;
-    shuffle_indices(idx, total_loaded);
+    order_questions(&stats, user_id, all, total_loaded, idx);
     
     for (int k = 0; k < ask_total; k++) {
         int qi = idx[k];
@@ -65,6 +107,7 @@ void run_learn_mode(const Chapter *chap) {
             printf("  %d) %s\n", i+1, q->options[i]);
         }
         printf("\nAnswer (1-4, q=quit): ");
+        long long shown_at = now_ms();
         char inp[16];
         read_line(inp, sizeof(inp));
         
@@ -73,6 +116,7 @@ void run_learn_mode(const Chapter *chap) {
             printf("\nPress Enter to return to menu...");
             char wait[8];
             read_line(wait, sizeof(wait));
+            stats_close(&stats);
             return;
         }
         
@@ -87,6 +131,8 @@ void run_learn_mode(const Chapter *chap) {
         }
         
         int correct = q->correctIndex + 1;
+        stats_record_answer(&stats, user_id, question_id(q), ans == correct);
+        log_answer_event(user_id, question_id(q), ans, ans == correct, now_ms() - shown_at);
         printf("\n");
         if (ans == correct) {
             printf("Correct! ");
@@ -95,15 +141,18 @@ void run_learn_mode(const Chapter *chap) {
         }
         printf("The correct answer is %d) %s\n", correct, q->options[correct-1]);
         
-        /* Show explanation if available */
-        if (q->explanation[0] != '\0') {
-            printf("\nExplanation: %s\n", q->explanation);
+        /* Show explanation if available (read from disk only now) */
+        char *expl = load_explanation(q);
+        if (expl) {
+            printf("\nExplanation: %s\n", expl);
+            free(expl);
         }
         
         printf("\nPress Enter to continue to next question...");
         char wait[8];
         read_line(wait, sizeof(wait));
     }
+    stats_close(&stats);
     
     clear_screen();
     printf("=== Learn Mode Complete ===\n");
@@ -129,6 +178,8 @@ void run_test_mode(const Chapter *chap, const char *username) {
         total_loaded = fallback_quiz(chap, all, MAX_QUESTIONS);
         printf("(Using sample quiz: %d questions)\n\n", total_loaded);
     }
+    ExamIndex ix;
+    exam_index_build(&ix, all, total_loaded); /* once per bank load */
 
     /* Ask user for number of questions */
     printf("How many questions would you like? (Press Enter for all %d questions): ", total_loaded);
@@ -148,9 +199,16 @@ void run_test_mode(const Chapter *chap, const char *username) {
         }
     }
 
+    StatsStore stats;
+    stats_open(&stats, STATS_FILE);
+    uint64_t user_id = hash_string(username);
+
+    /* Adaptive preference order, then an exam that covers every topic */
+    int order[MAX_QUESTIONS];
+    order_questions(&stats, user_id, all, total_loaded, order);
     int idx[MAX_QUESTIONS];
-    for (int i = 0; i < total_loaded; i++) idx[i] = i;
-    shuffle_indices(idx, total_loaded);
+    ask_total = select_exam(&ix, order, total_loaded, ask_total, idx);
+    exam_index_free(&ix);
     int answers[MAX_QUESTIONS] = {0};
     
     /* Collect all answers without showing feedback */
@@ -165,6 +223,7 @@ void run_test_mode(const Chapter *chap, const char *username) {
             printf("  %d) %s\n", i+1, q->options[i]);
         }
         printf("\nAnswer (1-4, q=quit): ");
+        long long shown_at = now_ms();
         char inp[16];
         read_line(inp, sizeof(inp));
         
@@ -173,6 +232,7 @@ void run_test_mode(const Chapter *chap, const char *username) {
             printf("\nPress Enter to return to menu...");
             char wait[8];
             read_line(wait, sizeof(wait));
+            stats_close(&stats);
             return;
         }
         
@@ -187,7 +247,10 @@ void run_test_mode(const Chapter *chap, const char *username) {
         }
         
         answers[k] = ans;
+        stats_record_answer(&stats, user_id, question_id(q), ans == q->correctIndex + 1);
+        log_answer_event(user_id, question_id(q), ans, ans == q->correctIndex + 1, now_ms() - shown_at);
     }
+    stats_close(&stats);
     
     /* Calculate score and show results */
     int score = 0;
@@ -211,8 +274,10 @@ void run_test_mode(const Chapter *chap, const char *username) {
             printf("Status: INCORRECT\n");
         }
         
-        if (q->explanation[0] != '\0') {
-            printf("Explanation: %s\n", q->explanation);
+        char *expl = load_explanation(q);
+        if (expl) {
+            printf("Explanation: %s\n", expl);
+            free(expl);
         }
         printf("\n");
     }
@@ -229,6 +294,14 @@ void run_test_mode(const Chapter *chap, const char *username) {
     
     /* Log test results */
     log_test_result(username, chap->code, score, ask_total);
+
+    /* Where this result stands among everyone's results for the chapter */
+    double percentile, median;
+    long result_count;
+    if (score_index_query(chap->code, percentage, &percentile, &median, &result_count)) {
+        printf("Percentile rank: %.0f (among %ld results)\n", percentile, result_count);
+        printf("Class median: %.1f%%\n", median);
+    }
     printf("\nResults saved to logs/quiz_score.log\n");
     printf("\nPress Enter to return to menu...");
     char wait[8];
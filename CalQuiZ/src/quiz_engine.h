@@ -4,7 +4,7 @@
 #include "data_structs.h"
 
 /* Learn mode: Show immediate feedback with explanations (no score recording) */
-void run_learn_mode(const Chapter *chap);
+void run_learn_mode(const Chapter *chap, const char *username);
 
 /* Test mode: Collect all answers, then show results and record score */
 void run_test_mode(const Chapter *chap, const char *username);
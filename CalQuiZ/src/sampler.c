@@ -0,0 +1,98 @@
+#include "sampler.h"
+#include "data_load.h"
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <math.h>
+
+#define RADIX_BITS 16
+#define RADIX_PASSES 3 /* sort on the top 48 bits of the key */
+#define SMALL_ORDER 256 /* up to this many items: insertion sort on the stack */
+
+/* Uniform double in (0, 1]; combines two rand() calls when
+   RAND_MAX is small (32767 on Windows) */
+static double rand_unit(void) {
+    double hi = (double)rand() / ((double)RAND_MAX + 1.0);
+#if RAND_MAX < 0x7FFFFFFF
+    double lo = (double)rand() / ((double)RAND_MAX + 1.0);
+    hi += lo / ((double)RAND_MAX + 1.0);
+#endif
+    return 1.0 - hi;
+}
+
+/* Fill idx with 0..n-1 so that each position is drawn with probability
+   proportional to the weights of the items not yet placed.
+   Items with weight <= 0 come last, in random order. */
+void weighted_order(int *idx, const double *weights, int n) {
+    for (int i = 0; i < n; i++) idx[i] = i;
+
+    /* Question banks are small (MAX_QUESTIONS): insertion sort beats the
+       radix passes there and needs no allocation */
+    if (n <= SMALL_ORDER) {
+        double small_keys[SMALL_ORDER];
+        for (int i = 0; i < n; i++) {
+            double u = rand_unit();
+            double key = weights[i] > 0.0 ? -log(u) / weights[i] : 1e300 * (1.0 + u);
+            int j = i;
+            while (j > 0 && small_keys[j - 1] > key) {
+                small_keys[j] = small_keys[j - 1];
+                idx[j] = idx[j - 1];
+                j--;
+            }
+            small_keys[j] = key;
+            idx[j] = i;
+        }
+        return;
+    }
+
+    uint64_t *keys = malloc((size_t)n * sizeof(*keys));
+    uint64_t *keys_tmp = malloc((size_t)n * sizeof(*keys_tmp));
+    int *idx_tmp = malloc((size_t)n * sizeof(*idx_tmp));
+    size_t *counts = malloc(((size_t)1 << RADIX_BITS) * sizeof(*counts));
+    if (!keys || !keys_tmp || !idx_tmp || !counts) {
+        shuffle_indices(idx, n); /* no memory: plain random order */
+        free(keys);
+        free(keys_tmp);
+        free(idx_tmp);
+        free(counts);
+        return;
+    }
+
+    /* Positive doubles order the same way as their bit patterns */
+    for (int i = 0; i < n; i++) {
+        double u = rand_unit();
+        double key = weights[i] > 0.0 ? -log(u) / weights[i] : 1e300 * (1.0 + u);
+        memcpy(&keys[i], &key, sizeof(key));
+    }
+
+    /* LSD radix sort of (key, index) pairs, ping-ponging between buffers */
+    int *cur_idx = idx, *next_idx = idx_tmp;
+    for (int pass = 0; pass < RADIX_PASSES; pass++) {
+        int shift = 64 - RADIX_BITS * (RADIX_PASSES - pass);
+        memset(counts, 0, ((size_t)1 << RADIX_BITS) * sizeof(*counts));
+        for (int i = 0; i < n; i++) counts[(keys[i] >> shift) & ((1u << RADIX_BITS) - 1)]++;
+        size_t at = 0;
+        for (size_t d = 0; d < ((size_t)1 << RADIX_BITS); d++) {
+            size_t c = counts[d];
+            counts[d] = at;
+            at += c;
+        }
+        for (int i = 0; i < n; i++) {
+            size_t to = counts[(keys[i] >> shift) & ((1u << RADIX_BITS) - 1)]++;
+            keys_tmp[to] = keys[i];
+            next_idx[to] = cur_idx[i];
+        }
+        uint64_t *k = keys;
+        keys = keys_tmp;
+        keys_tmp = k;
+        int *t = cur_idx;
+        cur_idx = next_idx;
+        next_idx = t;
+    }
+    if (cur_idx != idx) memcpy(idx, cur_idx, (size_t)n * sizeof(*idx));
+
+    free(keys);
+    free(keys_tmp);
+    free(idx_tmp);
+    free(counts);
+}
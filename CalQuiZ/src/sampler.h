@@ -0,0 +1,16 @@
+#ifndef SAMPLER_H
+#define SAMPLER_H
+
+/*
+ * Weighted random order without replacement (Efraimidis-Spirakis):
+ * every item gets the key -ln(u)/weight and items are listed by
+ * ascending key. Small inputs (every question bank) use an insertion
+ * sort; large ones a 3-pass radix sort, so the cost stays O(n).
+ */
+
+/* Fill idx with 0..n-1 so that each position is drawn with probability
+   proportional to the weights of the items not yet placed.
+   Items with weight <= 0 come last, in random order. */
+void weighted_order(int *idx, const double *weights, int n);
+
+#endif /* SAMPLER_H */
@@ -0,0 +1,223 @@
+#include "score_index.h"
+#include "logging.h"
+#include "utils.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stddef.h>
+
+#define LINE_MAX_LEN 1024
+
+static int bucket_of(int score, int total) {
+    if (total <= 0) return 0;
+    if (score < 0) score = 0;
+    if (score > total) score = total;
+    return (int)(((long long)score * 1000 + total / 2) / total);
+}
+
+static int same_code(const ScoreDist *d, const char *code) {
+    return strncmp(d->code, code, sizeof(d->code) - 1) == 0;
+}
+
+/* Open the index; a file that is not a whole number of records (e.g.
+   one written before the code field was widened) counts as missing */
+static FILE *open_index(const char *mode) {
+    long long size = file_size(SCORE_INDEX_FILE);
+    if (size < 0 || size % (long long)sizeof(ScoreDist) != 0) return NULL;
+    return fopen(SCORE_INDEX_FILE, mode);
+}
+
+/* Find the chapter's record; returns its index in the file or -1 (fp left after it) */
+static long find_dist(FILE *fp, const char *code, ScoreDist *d) {
+    rewind(fp);
+    long i = 0;
+    while (fread(d, sizeof(*d), 1, fp) == 1) {
+        if (same_code(d, code)) return i;
+        i++;
+    }
+    return -1;
+}
+
+/* Recreate the index from every [TEST] line in the score log */
+static void rebuild_from_log(void) {
+    FILE *log = fopen(LOG_FILE, "r");
+    FILE *fp = fopen(SCORE_INDEX_FILE, "w+b");
+    if (!fp) {
+        if (log) fclose(log);
+        return;
+    }
+    if (!log) {
+        fclose(fp);
+        return;
+    }
+
+    ScoreDist *dists = NULL;
+    int count = 0;
+    char line[LINE_MAX_LEN];
+    while (fgets(line, sizeof(line), log)) {
+        TestLine t;
+        if (!parse_test_line(line, line + strlen(line), &t)) continue;
+
+        char code[MAX_CHAPTER_LIST] = {0};
+        int len = t.chap_len < MAX_CHAPTER_LIST - 1 ? t.chap_len : MAX_CHAPTER_LIST - 1;
+        memcpy(code, t.chap, (size_t)len);
+
+        int i = 0;
+        while (i < count && !same_code(&dists[i], code)) i++;
+        if (i == count) {
+            ScoreDist *grown = realloc(dists, (size_t)(count + 1) * sizeof(*grown));
+            if (!grown) break;
+            dists = grown;
+            memset(&dists[count], 0, sizeof(dists[count]));
+            memcpy(dists[count].code, code, sizeof(code));
+            count++;
+        }
+        dists[i].total++;
+        dists[i].buckets[bucket_of(t.score, t.total)]++;
+    }
+
+    if (count > 0) fwrite(dists, sizeof(*dists), (size_t)count, fp);
+    free(dists);
+    fclose(log);
+    fclose(fp);
+}
+
+/* Count one result in the open index; d is scratch space */
+static void add_to_index(FILE *fp, ScoreDist *d, const char *chap_code, int score, int total) {
+    long i = find_dist(fp, chap_code, d);
+    int b = bucket_of(score, total);
+
+    if (i < 0) {
+        /* New chapter: append a fresh record */
+        memset(d, 0, sizeof(*d));
+        strncpy(d->code, chap_code, sizeof(d->code) - 1);
+        d->total = 1;
+        d->buckets[b] = 1;
+        fseek(fp, 0, SEEK_END);
+        fwrite(d, sizeof(*d), 1, fp);
+    } else {
+        /* Existing chapter: rewrite just the total and one bucket */
+        long base = i * (long)sizeof(ScoreDist);
+        d->total++;
+        d->buckets[b]++;
+        fseek(fp, base + (long)offsetof(ScoreDist, total), SEEK_SET);
+        fwrite(&d->total, sizeof(d->total), 1, fp);
+        fseek(fp, base + (long)offsetof(ScoreDist, buckets) + b * (long)sizeof(uint32_t), SEEK_SET);
+        fwrite(&d->buckets[b], sizeof(d->buckets[b]), 1, fp);
+    }
+}
+
+/* Add one result to the chapter's distribution (called from log_test_result).
+   If the index file is missing it is rebuilt from the score log instead. */
+void score_index_add(const char *chap_code, int score, int total) {
+    FILE *fp = open_index("r+b");
+    if (!fp) {
+        /* The log already holds this result, so the rebuild includes it */
+        rebuild_from_log();
+        return;
+    }
+
+    ScoreDist *d = malloc(sizeof(*d));
+    if (d) add_to_index(fp, d, chap_code, score, total);
+    free(d);
+    fclose(fp);
+}
+
+/* Same as score_index_add for many results: the index is read once,
+   counts are added in memory and each changed record is written once */
+void score_index_add_batch(const TestResult *results, int n) {
+    FILE *fp = open_index("r+b");
+    if (!fp) {
+        rebuild_from_log();
+        return;
+    }
+
+    /* The index is one record per chapter, so it fits in memory */
+    long long size = file_size(SCORE_INDEX_FILE);
+    int count = (int)(size / (long long)sizeof(ScoreDist));
+    ScoreDist *dists = malloc(((size_t)count + 1) * sizeof(*dists));
+    char *dirty = calloc((size_t)count + 1, 1);
+    if (!dists || !dirty || fread(dists, sizeof(*dists), (size_t)count, fp) != (size_t)count) {
+        free(dists);
+        free(dirty);
+        fclose(fp);
+        return;
+    }
+
+    int old_count = count;
+    int last = -1; /* results usually come in runs of one chapter */
+    for (int r = 0; r < n; r++) {
+        const char *code = results[r].chap_code;
+        int i = last;
+        if (i < 0 || !same_code(&dists[i], code)) {
+            i = 0;
+            while (i < count && !same_code(&dists[i], code)) i++;
+        }
+        if (i == count) {
+            ScoreDist *grown = realloc(dists, ((size_t)count + 1) * sizeof(*grown));
+            char *grown_dirty = realloc(dirty, (size_t)count + 1);
+            if (grown) dists = grown;
+            if (grown_dirty) dirty = grown_dirty;
+            if (!grown || !grown_dirty) break;
+            memset(&dists[count], 0, sizeof(dists[count]));
+            strncpy(dists[count].code, code, sizeof(dists[count].code) - 1);
+            count++;
+        }
+        dists[i].total++;
+        dists[i].buckets[bucket_of(results[r].score, results[r].total)]++;
+        dirty[i] = 1;
+        last = i;
+    }
+
+    /* Changed records in place, new chapters appended */
+    for (int i = 0; i < old_count; i++) {
+        if (!dirty[i]) continue;
+        fseek(fp, i * (long)sizeof(ScoreDist), SEEK_SET);
+        fwrite(&dists[i], sizeof(dists[i]), 1, fp);
+    }
+    if (count > old_count) {
+        fseek(fp, 0, SEEK_END);
+        fwrite(&dists[old_count], sizeof(*dists), (size_t)(count - old_count), fp);
+    }
+    free(dists);
+    free(dirty);
+    fclose(fp);
+}
+
+/* Percentile rank (0-100) of a percentage within its chapter, plus the
+   chapter median and result count. Returns 0 if the chapter has no results. */
+int score_index_query(const char *chap_code, double percentage,
+                      double *percentile, double *median, long *count) {
+    FILE *fp = open_index("rb");
+    if (!fp) return 0;
+    ScoreDist *d = malloc(sizeof(*d));
+    if (!d) {
+        fclose(fp);
+        return 0;
+    }
+    long i = find_dist(fp, chap_code, d);
+    fclose(fp);
+    if (i < 0 || d->total == 0) {
+        free(d);
+        return 0;
+    }
+
+    /* Fixed number of buckets, so this is O(1) in the number of results */
+    int mine = (int)(percentage * 10.0 + 0.5);
+    if (mine < 0) mine = 0;
+    if (mine >= SCORE_BUCKETS) mine = SCORE_BUCKETS - 1;
+    unsigned long below = 0;
+    for (int b = 0; b < mine; b++) below += d->buckets[b];
+    *percentile = 100.0 * (below + 0.5 * d->buckets[mine]) / d->total;
+
+    unsigned long half = (d->total + 1) / 2, seen = 0;
+    int b = 0;
+    for (; b < SCORE_BUCKETS; b++) {
+        seen += d->buckets[b];
+        if (seen >= half) break;
+    }
+    *median = b / 10.0;
+    *count = (long)d->total;
+    free(d);
+    return 1;
+}
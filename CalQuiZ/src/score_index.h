@@ -0,0 +1,31 @@
+#ifndef SCORE_INDEX_H
+#define SCORE_INDEX_H
+
+#include <stdint.h>
+#include "data_structs.h"
+#include "logging.h"
+
+#define SCORE_INDEX_FILE "logs/score_index.dat"
+#define SCORE_BUCKETS 1001 /* 0.0% .. 100.0% in steps of 0.1% */
+
+/* Counting histogram of test percentages for one chapter, stored as-is on disk */
+typedef struct {
+    char code[MAX_CHAPTER_LIST];
+    uint32_t total;
+    uint32_t buckets[SCORE_BUCKETS];
+} ScoreDist;
+
+/* Add one result to the chapter's distribution (called from log_test_result).
+   If the index file is missing it is rebuilt from the score log instead. */
+void score_index_add(const char *chap_code, int score, int total);
+
+/* Same as score_index_add for many results: the index is read once,
+   counts are added in memory and each changed record is written once */
+void score_index_add_batch(const TestResult *results, int n);
+
+/* Percentile rank (0-100) of a percentage within its chapter, plus the
+   chapter median and result count. Returns 0 if the chapter has no results. */
+int score_index_query(const char *chap_code, double percentage,
+                      double *percentile, double *median, long *count);
+
+#endif /* SCORE_INDEX_H */
@@ -1,7 +1,21 @@
+#ifndef _WIN32
+#define _POSIX_C_SOURCE 200809L /* fseeko/ftello */
+#define _FILE_OFFSET_BITS 64
+#endif
+
 #include "utils.h"
 #include <stdio.h>
 #include <string.h>
 #include <stdlib.h>
+#include <time.h>
+
+#ifdef _WIN32
+#include <direct.h>
+#include <io.h>
+#else
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
 
 #ifdef _WIN32
 #include <windows.h>
@@ -54,3 +68,50 @@ void setup_console_utf8(void) {
 #endif
 }
 
+/* Create a directory if it doesn't exist */
+void ensure_dir(const char *path) {
+#ifdef _WIN32
+    if (_access(path, 0) != 0) {
+        _mkdir(path);
+    }
+#else
+    struct stat st = {0};
+    if (stat(path, &st) == -1) {
+        mkdir(path, 0700);
+    }
+#endif
+}
+
+/* Wall-clock time in milliseconds (for answer latency) */
+long long now_ms(void) {
+    struct timespec ts;
+    if (timespec_get(&ts, TIME_UTC) != TIME_UTC) {
+        return (long long)time(NULL) * 1000;
+    }
+    return (long long)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+/* Size of a file in bytes (64-bit safe); -1 if it can't be opened */
+long long file_size(const char *path) {
+    FILE *fp = fopen(path, "rb");
+    if (!fp) return -1;
+    long long size;
+#ifdef _WIN32
+    _fseeki64(fp, 0, SEEK_END);
+    size = _ftelli64(fp);
+#else
+    fseeko(fp, 0, SEEK_END);
+    size = (long long)ftello(fp);
+#endif
+    fclose(fp);
+    return size;
+}
+
+/* Seek to a 64-bit offset from the start of the file; 0 on success */
+int file_seek(FILE *fp, long long offset) {
+#ifdef _WIN32
+    return _fseeki64(fp, offset, SEEK_SET);
+#else
+    return fseeko(fp, (off_t)offset, SEEK_SET);
+#endif
+}
@@ -2,6 +2,7 @@
 #define UTILS_H
 
 #include <stddef.h>
+#include <stdio.h>
 
 /* Utility: trim newline */
 void trim_newline(char *s);
@@ -15,5 +16,17 @@ void clear_screen(void);
 /* Console UTF-8 setup */
 void setup_console_utf8(void);
 
+/* Create a directory if it doesn't exist */
+void ensure_dir(const char *path);
+
+/* Wall-clock time in milliseconds (for answer latency) */
+long long now_ms(void);
+
+/* Size of a file in bytes (64-bit safe); -1 if it can't be opened */
+long long file_size(const char *path);
+
+/* Seek to a 64-bit offset from the start of the file; 0 on success */
+int file_seek(FILE *fp, long long offset);
+
 #endif /* UTILS_H */
 